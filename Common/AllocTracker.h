@@ -0,0 +1,310 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+
+// Allocation accounting: counts, bytes and high-water marks of heap memory per component and recursion level.
+// Accounting is opt-in, exactly one translation unit of an executable expands UTILS_DEFINE_ALLOCATION_TRACKING() to
+// replace global operator new/delete, without it all counters stay zero. Every block remembers slot of the thread
+// context at the moment of allocation, so memory freed by another component or thread is returned to its owner.
+namespace Utils::Alloc
+{
+enum class Component : uint8_t
+{
+    Other,
+    Graph,
+    MSTTree,
+    SoftHeap,
+    Count
+};
+
+// Recursion levels above the last one are accounted to the last one
+inline constexpr size_t max_levels = 16;
+
+struct Stats
+{
+    size_t allocations{};
+    size_t deallocations{};
+    size_t bytes{}; // allocated since reset
+    size_t live_bytes{};
+    size_t peak_bytes{}; // high-water mark of live bytes since reset
+};
+
+namespace Details
+{
+struct Slot
+{
+    std::atomic<size_t> allocations{};
+    std::atomic<size_t> deallocations{};
+    std::atomic<size_t> bytes{};
+    std::atomic<size_t> live_bytes{};
+    std::atomic<size_t> peak_bytes{};
+
+    void OnAllocate(size_t size)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+        const auto live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        auto       peak = peak_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+
+    void OnDeallocate(size_t size)
+    {
+        deallocations.fetch_add(1, std::memory_order_relaxed);
+        live_bytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+
+    Stats Load() const
+    {
+        return Stats{allocations.load(std::memory_order_relaxed),
+                     deallocations.load(std::memory_order_relaxed),
+                     bytes.load(std::memory_order_relaxed),
+                     live_bytes.load(std::memory_order_relaxed),
+                     peak_bytes.load(std::memory_order_relaxed)};
+    }
+
+    // Live bytes are kept: blocks allocated before reset are still returned
+    void Reset()
+    {
+        allocations   = 0;
+        deallocations = 0;
+        bytes         = 0;
+        peak_bytes    = live_bytes.load();
+    }
+};
+
+inline constexpr size_t components_count = static_cast<size_t>(Component::Count);
+
+// Constant initialized, operator new may be called before any dynamic initialization
+struct Registry
+{
+    std::array<Slot, components_count * max_levels> slots{};
+    std::array<Slot, components_count>              components{};
+    Slot                                            total{};
+    std::atomic<bool>                               installed{};
+};
+
+inline constinit Registry s_registry{};
+
+struct ThreadContext
+{
+    uint8_t component{};
+    uint8_t level{};
+    size_t  allocations{};
+};
+
+inline constinit thread_local ThreadContext s_context{};
+
+// Stored right before every tracked block, offset leads back to the start of the underlying allocation
+struct Header
+{
+    size_t   size;
+    uint32_t slot;
+    uint32_t offset;
+};
+
+inline constexpr size_t header_space = (sizeof(Header) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) *
+                                       alignof(std::max_align_t);
+
+inline uint32_t CurrentSlot() { return static_cast<uint32_t>(s_context.component * max_levels + s_context.level); }
+
+// Every block comes from std::malloc, over-aligned blocks are over-allocated and aligned inside, so all of them are
+// freed with std::free on any platform. Header is reached through integer addresses: compiler sees returned block as
+// an object of operator new, pointer arithmetic before its start would trigger -Warray-bounds and freeing it
+// -Wmismatched-new-delete
+inline void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+{
+    const auto padding = alignment > alignof(std::max_align_t) ? alignment - alignof(std::max_align_t) : 0;
+    auto*      origin  = std::malloc(header_space + padding + size);
+    if (!origin)
+        return nullptr;
+
+    const auto address = (reinterpret_cast<uintptr_t>(origin) + header_space + padding) & ~(uintptr_t{alignment} - 1);
+    const auto header  = Header{size, CurrentSlot(), static_cast<uint32_t>(address - reinterpret_cast<uintptr_t>(origin))};
+    std::memcpy(reinterpret_cast<void*>(address - sizeof(Header)), &header, sizeof(Header));
+    ++s_context.allocations;
+    s_registry.slots[header.slot].OnAllocate(size);
+    s_registry.components[header.slot / max_levels].OnAllocate(size);
+    s_registry.total.OnAllocate(size);
+    return reinterpret_cast<void*>(address);
+}
+
+inline void Deallocate(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    Header header;
+    std::memcpy(&header, reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(ptr) - sizeof(Header)), sizeof(Header));
+    s_registry.slots[header.slot].OnDeallocate(header.size);
+    s_registry.components[header.slot / max_levels].OnDeallocate(header.size);
+    s_registry.total.OnDeallocate(header.size);
+    std::free(reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(ptr) - header.offset));
+}
+} // namespace Details
+
+class Report
+{
+public:
+    Report()
+    {
+        for (size_t i = 0; i < m_slots.size(); ++i)
+            m_slots[i] = Details::s_registry.slots[i].Load();
+        for (size_t i = 0; i < m_components.size(); ++i)
+            m_components[i] = Details::s_registry.components[i].Load();
+        m_total = Details::s_registry.total.Load();
+    }
+
+    const Stats& Get(Component component, size_t level) const
+    {
+        return m_slots[static_cast<size_t>(component) * max_levels + std::min(level, max_levels - 1)];
+    }
+    const Stats& Get(Component component) const { return m_components[static_cast<size_t>(component)]; }
+    const Stats& GetTotal() const { return m_total; }
+
+    // Highest level with allocations of any component
+    size_t GetMaxLevel() const
+    {
+        size_t result = 0;
+        for (size_t i = 0; i < m_slots.size(); ++i)
+            if (m_slots[i].allocations)
+                result = std::max(result, i % max_levels);
+        return result;
+    }
+
+private:
+    std::array<Stats, Details::components_count * max_levels> m_slots{};
+    std::array<Stats, Details::components_count>              m_components{};
+    Stats                                                     m_total{};
+};
+
+inline bool   IsInstalled() { return Details::s_registry.installed.load(std::memory_order_relaxed); }
+inline Report GetReport() { return Report{}; }
+// Allocations made by calling thread since its start, for checks that a loop doesn't allocate
+inline size_t GetThreadAllocations() { return Details::s_context.allocations; }
+
+inline void Reset()
+{
+    for (auto& slot : Details::s_registry.slots)
+        slot.Reset();
+    for (auto& slot : Details::s_registry.components)
+        slot.Reset();
+    Details::s_registry.total.Reset();
+}
+
+// Accounts allocations of calling thread to component till destruction
+class ComponentScope
+{
+public:
+    explicit ComponentScope(Component component)
+        : m_previous{Details::s_context.component}
+    {
+        Details::s_context.component = static_cast<uint8_t>(component);
+    }
+    ~ComponentScope() { Details::s_context.component = m_previous; }
+
+    ComponentScope(const ComponentScope&)            = delete;
+    ComponentScope& operator=(const ComponentScope&) = delete;
+
+private:
+    const uint8_t m_previous;
+};
+
+// Accounts allocations of calling thread to recursion level till destruction
+class LevelScope
+{
+public:
+    explicit LevelScope(size_t level)
+        : m_previous{Details::s_context.level}
+    {
+        Details::s_context.level = static_cast<uint8_t>(std::min(level, max_levels - 1));
+    }
+    ~LevelScope() { Details::s_context.level = m_previous; }
+
+    LevelScope(const LevelScope&)            = delete;
+    LevelScope& operator=(const LevelScope&) = delete;
+
+private:
+    const uint8_t m_previous;
+};
+
+// Upstream for pmr pools: blocks requested by the pool are accounted to component whoever triggers the request
+class ComponentResource final : public std::pmr::memory_resource
+{
+public:
+    explicit ComponentResource(Component component, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : m_component{component}
+        , m_upstream{upstream} {}
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        ComponentScope scope{m_component};
+        return m_upstream->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override { m_upstream->deallocate(ptr, bytes, alignment); }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    const Component            m_component;
+    std::pmr::memory_resource* m_upstream;
+};
+} // namespace Utils::Alloc
+
+#define UTILS_DEFINE_ALLOCATION_TRACKING()                                                                              \
+    void* operator new(std::size_t size)                                                                               \
+    {                                                                                                                  \
+        if (auto* ptr = ::Utils::Alloc::Details::Allocate(size))                                                       \
+            return ptr;                                                                                                \
+        throw std::bad_alloc{};                                                                                        \
+    }                                                                                                                  \
+    void* operator new[](std::size_t size) { return operator new(size); }                                             \
+    void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return ::Utils::Alloc::Details::Allocate(size); } \
+    void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return ::Utils::Alloc::Details::Allocate(size); } \
+    void  operator delete(void* ptr) noexcept { ::Utils::Alloc::Details::Deallocate(ptr); }                            \
+    void  operator delete[](void* ptr) noexcept { ::Utils::Alloc::Details::Deallocate(ptr); }                          \
+    void  operator delete(void* ptr, std::size_t) noexcept { ::Utils::Alloc::Details::Deallocate(ptr); }               \
+    void  operator delete[](void* ptr, std::size_t) noexcept { ::Utils::Alloc::Details::Deallocate(ptr); }             \
+    void  operator delete(void* ptr, const std::nothrow_t&) noexcept { ::Utils::Alloc::Details::Deallocate(ptr); }     \
+    void  operator delete[](void* ptr, const std::nothrow_t&) noexcept { ::Utils::Alloc::Details::Deallocate(ptr); }   \
+    void* operator new(std::size_t size, std::align_val_t alignment)                                                   \
+    {                                                                                                                  \
+        if (auto* ptr = ::Utils::Alloc::Details::Allocate(size, static_cast<std::size_t>(alignment)))                  \
+            return ptr;                                                                                                \
+        throw std::bad_alloc{};                                                                                        \
+    }                                                                                                                  \
+    void* operator new[](std::size_t size, std::align_val_t alignment) { return operator new(size, alignment); }      \
+    void  operator delete(void* ptr, std::align_val_t) noexcept { ::Utils::Alloc::Details::Deallocate(ptr); }          \
+    void  operator delete[](void* ptr, std::align_val_t) noexcept { ::Utils::Alloc::Details::Deallocate(ptr); }        \
+    void  operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { ::Utils::Alloc::Details::Deallocate(ptr); } \
+    void  operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { ::Utils::Alloc::Details::Deallocate(ptr); } \
+    static const bool s_utils_allocation_tracking_installed = (::Utils::Alloc::Details::s_registry.installed = true)
@@ -22,12 +22,20 @@
 
 #pragma once
 
+#include "Profiler.h"
+
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <ranges>
+#include <set>
+#include <string>
 #include <vector>
 
 namespace Utils
@@ -37,8 +45,9 @@ inline size_t CalculateRByEps(double eps)
     return static_cast<size_t>(2.0 + 2.0 * std::ceil(std::log(1.0 / eps)));
 }
 
-template<typename SoftHeap>
-int SoftHeapSelect(std::vector<int> a, int k)
+// Returns k-th smallest element, SoftHeap must be a soft heap of T
+template<typename SoftHeap, typename T>
+T SoftHeapSelect(std::vector<T> a, size_t k)
 {
     if (a.size() <= 3)
     {
@@ -50,27 +59,27 @@ int SoftHeapSelect(std::vector<int> a, int k)
     for (auto& v : a)
         heap.Insert(v);
 
-    int max_value = -1;
-    for (int i = 0; i < static_cast<int>(a.size() / 3); ++i)
+    T max_value = heap.DeleteMin();
+    for (size_t i = 1; i < a.size() / 3; ++i)
     {
         auto removed = heap.DeleteMin();
-        if (removed >= max_value)
-            max_value = removed;
+        if (max_value < removed)
+            max_value = std::move(removed);
     }
 
-    const auto partition_itr   = std::partition(a.begin(), a.end(), [&](int value) { return value < max_value; });
-    const auto partition_index = std::distance(a.begin(), partition_itr);
+    const auto partition_itr   = std::partition(a.begin(), a.end(), [&](const T& value) { return value < max_value; });
+    const auto partition_index = static_cast<size_t>(std::distance(a.begin(), partition_itr));
 
     if (partition_index == k)
         return max_value;
 
     if (k < partition_index)
-        return SoftHeapSelect<SoftHeap>(std::vector<int>{a.begin(), partition_itr}, k);
+        return SoftHeapSelect<SoftHeap>(std::vector<T>{a.begin(), partition_itr}, k);
 
     // Move max_value to the correct position
-    std::partition(partition_itr, a.end(), [&](int value) { return value <= max_value; });
+    std::partition(partition_itr, a.end(), [&](const T& value) { return !(max_value < value); });
 
-    return SoftHeapSelect<SoftHeap>(std::vector<int>{partition_itr + 1, a.end()}, k - (partition_index + 1));
+    return SoftHeapSelect<SoftHeap>(std::vector<T>{partition_itr + 1, a.end()}, k - (partition_index + 1));
 }
 
 
@@ -141,21 +150,199 @@ template<typename T>
 LazyList(typename std::list<T>::const_iterator begin, typename std::list<T>::const_iterator end) -> LazyList<T>;
 
 
+// Scoped tracing in Chrome trace event format, open result in chrome://tracing or ui.perfetto.dev.
+// Events are recorded only if TRACING_ENABLED is defined, otherwise UTILS_TRACE_SCOPE expands to nothing.
+// Every thread writes to its own ring buffer without locks, oldest events are overwritten when it is full.
+// WriteChromeTrace and ClearTrace must not run concurrently with traced code
+namespace Trace
+{
+struct Event
+{
+    const char* name;        // must outlive the trace, string literals or Intern
+    uint64_t    start_ns;
+    uint64_t    duration_ns;
+};
+
+class ThreadBuffer
+{
+public:
+    static constexpr size_t capacity = size_t{1} << 16;
+
+    explicit ThreadBuffer(size_t thread_id)
+        : m_thread_id{thread_id} {}
+
+    void Push(const Event& event)
+    {
+        if (m_events.size() < capacity)
+            m_events.push_back(event);
+        else
+            m_events[m_written % capacity] = event;
+        ++m_written;
+    }
+
+    void Clear()
+    {
+        m_events.clear();
+        m_written = 0;
+    }
+
+    size_t GetThreadId() const { return m_thread_id; }
+
+    // Events in order of recording
+    template<typename Action>
+    void ForEach(Action&& action) const
+    {
+        const size_t first = m_written > capacity ? m_written % capacity : 0;
+        for (size_t i = 0; i < m_events.size(); ++i)
+            action(m_events[(first + i) % m_events.size()]);
+    }
+
+private:
+    const size_t       m_thread_id;
+    std::vector<Event> m_events{};
+    size_t             m_written{};
+};
+
+class Registry
+{
+public:
+    static Registry& Instance()
+    {
+        static Registry s_registry{};
+        return s_registry;
+    }
+
+    // Buffers are owned by registry, so events of finished threads of pools are kept
+    ThreadBuffer& GetThreadBuffer()
+    {
+        thread_local ThreadBuffer* s_buffer = nullptr;
+        if (!s_buffer)
+        {
+            std::lock_guard lock{m_mutex};
+            s_buffer = m_buffers.emplace_back(std::make_unique<ThreadBuffer>(m_buffers.size() + 1)).get();
+        }
+        return *s_buffer;
+    }
+
+    // Nanoseconds since creation of registry
+    uint64_t Now() const
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count());
+    }
+
+    const char* Intern(const std::string& name)
+    {
+        std::lock_guard lock{m_mutex};
+        return m_names.insert(name).first->c_str();
+    }
+
+    void Clear()
+    {
+        std::lock_guard lock{m_mutex};
+        for (auto& buffer : m_buffers)
+            buffer->Clear();
+    }
+
+    void WriteChromeTrace(std::ostream& out)
+    {
+        std::lock_guard lock{m_mutex};
+        out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+        bool first = true;
+        for (const auto& buffer : m_buffers)
+        {
+            buffer->ForEach([&](const Event& event)
+            {
+                out << (first ? "\n" : ",\n") << "  {\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+                    << buffer->GetThreadId() << ", \"ts\": " << static_cast<double>(event.start_ns) / 1000.0
+                    << ", \"dur\": " << static_cast<double>(event.duration_ns) / 1000.0 << "}";
+                first = false;
+            });
+        }
+        out << "\n]}" << std::endl;
+    }
+
+private:
+    Registry() = default;
+
+    const std::chrono::steady_clock::time_point m_epoch = std::chrono::steady_clock::now();
+    std::mutex                                  m_mutex{};
+    std::vector<std::unique_ptr<ThreadBuffer>>  m_buffers{};
+    std::set<std::string>                       m_names{};
+};
+
+// Records complete event from construction till destruction
+class Scope
+{
+public:
+    explicit Scope(const char* name)
+        : m_name{name}
+        , m_start{Registry::Instance().Now()} {}
+
+    ~Scope()
+    {
+        auto& registry = Registry::Instance();
+        registry.GetThreadBuffer().Push(Event{m_name, m_start, registry.Now() - m_start});
+    }
+
+    Scope(const Scope&)            = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t    m_start;
+};
+} // namespace Trace
+
+inline void WriteChromeTrace(std::ostream& out) { Trace::Registry::Instance().WriteChromeTrace(out); }
+inline void ClearTrace() { Trace::Registry::Instance().Clear(); }
+
+#define UTILS_TRACE_CONCAT_IMPL(a, b) a##b
+#define UTILS_TRACE_CONCAT(a, b) UTILS_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef TRACING_ENABLED
+#define UTILS_TRACE_SCOPE(name) const ::Utils::Trace::Scope UTILS_TRACE_CONCAT(trace_scope_, __LINE__){name}
+#else
+#define UTILS_TRACE_SCOPE(name)
+#endif
+
+// Scope of a phase: trace event if TRACING_ENABLED is defined, node of Utils::Profiler if PROFILING_ENABLED is defined,
+// nothing otherwise
+#ifdef PROFILING_ENABLED
+#define UTILS_PROFILE_SCOPE(name)                                                                                      \
+    UTILS_TRACE_SCOPE(name);                                                                                           \
+    const ::Utils::Profiler::Details::Frame UTILS_TRACE_CONCAT(profile_scope_, __LINE__) { name }
+#else
+#define UTILS_PROFILE_SCOPE(name) UTILS_TRACE_SCOPE(name)
+#endif
+
+// Prints execution time of scope, also records it as trace event and profiler node if they are enabled
 struct MeasurePerfomance
 {
     MeasurePerfomance(std::string name)
-        : m_name{std::move(name)} {}
+        : m_name{std::move(name)}
+#ifdef PROFILING_ENABLED
+        , m_profile_frame{m_name}
+#endif
+    {}
 
     ~MeasurePerfomance()
     {
-        auto end = std::chrono::high_resolution_clock::now();
+        const auto end = std::chrono::steady_clock::now();
+#ifdef TRACING_ENABLED
+        auto&      registry = Trace::Registry::Instance();
+        const auto duration = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_start).count());
+        registry.GetThreadBuffer().Push(Trace::Event{registry.Intern(m_name), registry.Now() - duration, duration});
+#endif
         std::cout << "[" << m_name << "] Execution time is " << std::chrono::duration_cast<
                     std::chrono::milliseconds>(end - m_start) <<
                 std::endl;
     }
 
 private:
-    const std::chrono::steady_clock::time_point m_start = std::chrono::high_resolution_clock::now();
+    const std::chrono::steady_clock::time_point m_start = std::chrono::steady_clock::now();
     const std::string                           m_name;
+#ifdef PROFILING_ENABLED
+    const Profiler::Details::Frame              m_profile_frame;
+#endif
 };
 } // namespace Utils
@@ -0,0 +1,138 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+namespace Utils
+{
+inline void Prefetch(const void* ptr)
+{
+#if defined(_MSC_VER)
+    _mm_prefetch(static_cast<const char*>(ptr), _MM_HINT_T0);
+#else
+    __builtin_prefetch(ptr);
+#endif
+}
+
+// Flat union-find over elements 0..n-1: union by size, iterative path halving.
+// Elements could be absent (sparse ids), absent elements are not counted as sets.
+class DisjointSets
+{
+public:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    DisjointSets() = default;
+
+    // All elements 0..n-1 are present as singletons
+    explicit DisjointSets(size_t n)
+        : m_parent(n)
+        , m_size(n, 1)
+        , m_sets_count{n}
+    {
+        for (size_t v = 0; v < n; ++v)
+            m_parent[v] = v;
+    }
+
+    // Make v singleton if it is absent
+    void Add(size_t v)
+    {
+        if (m_parent.size() <= v)
+        {
+            m_parent.resize(v + 1, npos);
+            m_size.resize(v + 1, 0);
+        }
+        if (m_parent[v] != npos)
+            return;
+
+        m_parent[v] = v;
+        m_size[v]   = 1;
+        ++m_sets_count;
+    }
+
+    bool Contains(size_t v) const { return v < m_parent.size() && m_parent[v] != npos; }
+    bool IsRoot(size_t v) const { return v < m_parent.size() && m_parent[v] == v; }
+
+    // Parent without compression, npos for absent elements. Safe for concurrent readers.
+    size_t GetParent(size_t v) const { return m_parent[v]; }
+
+    size_t Find(size_t v)
+    {
+        assert(Contains(v));
+        while (m_parent[v] != v)
+        {
+            m_parent[v] = m_parent[m_parent[v]];
+            v           = m_parent[v];
+        }
+        return v;
+    }
+
+    // Find for a batch of elements, parents are prefetched before any find to hide cache misses on large sets
+    void FindBatch(std::span<const size_t> elements, std::span<size_t> out_roots)
+    {
+        assert(elements.size() <= out_roots.size());
+        for (const auto v : elements)
+            Prefetch(&m_parent[v]);
+
+        for (size_t i = 0; i < elements.size(); ++i)
+            out_roots[i] = Find(elements[i]);
+    }
+
+    // Returns root of merged set
+    size_t Union(size_t a, size_t b)
+    {
+        a = Find(a);
+        b = Find(b);
+        if (a == b)
+            return a;
+
+        if (m_size[a] < m_size[b])
+            std::swap(a, b);
+
+        m_parent[b] = a;
+        m_size[a] += m_size[b];
+        --m_sets_count;
+        return a;
+    }
+
+    size_t GetSetsCount() const { return m_sets_count; }
+    size_t GetSetSize(size_t v) { return m_size[Find(v)]; }
+    size_t GetCapacity() const { return m_parent.size(); }
+    size_t GetMemoryUsage() const { return (m_parent.capacity() + m_size.capacity()) * sizeof(size_t); }
+
+private:
+    std::vector<size_t> m_parent{}; // npos for absent elements
+    std::vector<size_t> m_size{};   // valid only for roots
+    size_t              m_sets_count{};
+};
+} // namespace Utils
@@ -0,0 +1,180 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace Utils
+{
+using EdgesList = std::vector<std::tuple<size_t, size_t, size_t>>;
+
+inline void AssignUniqueWeights(EdgesList& edges, std::mt19937& g)
+{
+    std::vector<size_t> weights(edges.size());
+    std::iota(weights.begin(), weights.end(), 1);
+    std::ranges::shuffle(weights, g);
+    for (size_t index = 0; index < edges.size(); ++index)
+        std::get<2>(edges[index]) = weights[index];
+}
+
+// Graph with 2^k vertices, edges of each next level are copy of previous level shifted by N.
+// Each postprocess step adds new vertex per each edge. All weights are unique.
+inline EdgesList GenerateMatrix(uint32_t k, uint32_t postprocess)
+{
+    EdgesList edges{};
+    size_t    N = 1;
+    for (uint32_t i = 0; i < k; ++i)
+    {
+        auto size = edges.size();
+        for (size_t count = 0; count < size; ++count)
+        {
+            auto [i, j, w] = edges[count];
+            edges.emplace_back(i + N, j + N, 0);
+        }
+        edges.emplace_back(0, N, 0);
+        N *= 2;
+    }
+    for (uint32_t z = 0; z < postprocess; ++z)
+    {
+        for (auto count = static_cast<int64_t>(edges.size()) - 1; count >= 0; count--)
+        {
+            auto [i, j, w] = edges[count];
+            edges.emplace_back(i, N, 0);
+            edges.emplace_back(j, N, 0);
+            N += 1;
+        }
+    }
+
+    size_t weight = edges.size();
+    for (auto& edge : edges)
+        std::get<2>(edge) = weight--;
+    return edges;
+}
+
+// G(n, p) graph with unique weights 1..m in random order
+inline EdgesList ErdosRenie(size_t n, double p, uint32_t seed = 1)
+{
+    std::mt19937                     g(seed);
+    std::uniform_real_distribution<> dis(0.0, 1.0);
+
+    EdgesList result{};
+    result.reserve(static_cast<size_t>(static_cast<double>(n) * static_cast<double>(n) * p / 2.0));
+    if (p <= 0.0)
+        return result;
+
+    // Geometric skipping over pairs (i, j), i < j, keeps generation O(m) for sparse graphs
+    const double log_q = std::log(1.0 - std::min(p, 1.0 - 1e-12));
+    size_t       i     = 0;
+    size_t       j     = 0;
+    while (i < n)
+    {
+        j += 1 + static_cast<size_t>(std::floor(std::log(1.0 - dis(g)) / log_q));
+        // Move overflow to the next rows, row i contains pairs (i, i+1 ... n-1)
+        while (i < n && j >= n)
+        {
+            j = j - n + i + 2;
+            ++i;
+        }
+        if (i < n)
+            result.emplace_back(i, j, 0);
+    }
+
+    AssignUniqueWeights(result, g);
+    return result;
+}
+
+// rows x cols lattice, each vertex is connected with right and bottom neighbours. Unique weights 1..m in random order
+inline EdgesList Grid(size_t rows, size_t cols, uint32_t seed = 1)
+{
+    EdgesList result{};
+    result.reserve(2 * rows * cols);
+    for (size_t row = 0; row < rows; ++row)
+    {
+        for (size_t col = 0; col < cols; ++col)
+        {
+            const size_t vertex = row * cols + col;
+            if (col + 1 < cols)
+                result.emplace_back(vertex, vertex + 1, 0);
+            if (row + 1 < rows)
+                result.emplace_back(vertex, vertex + cols, 0);
+        }
+    }
+
+    std::mt19937 g(seed);
+    AssignUniqueWeights(result, g);
+    return result;
+}
+
+// Barabasi-Albert preferential attachment: each new vertex is connected with edges_per_vertex distinct vertices
+// chosen with probability proportional to their degree, so degrees follow power law. Unique weights 1..m in random order
+inline EdgesList PowerLaw(size_t n, size_t edges_per_vertex, uint32_t seed = 1)
+{
+    std::mt19937 g(seed);
+    EdgesList    result{};
+    if (edges_per_vertex == 0)
+        return result;
+
+    const size_t initial = std::min(n, edges_per_vertex + 1);
+    for (size_t i = 0; i < initial; ++i)
+        for (size_t j = i + 1; j < initial; ++j)
+            result.emplace_back(i, j, 0);
+
+    // Every vertex is repeated once per incident edge, uniform choice from it is the preferential one
+    std::vector<size_t> endpoints{};
+    for (const auto& [i, j, w] : result)
+    {
+        endpoints.push_back(i);
+        endpoints.push_back(j);
+    }
+
+    std::vector<size_t> targets{};
+    for (size_t vertex = initial; vertex < n; ++vertex)
+    {
+        targets.clear();
+        std::uniform_int_distribution<size_t> dis(0, endpoints.size() - 1);
+        while (targets.size() < edges_per_vertex)
+        {
+            const auto target = endpoints[dis(g)];
+            if (std::ranges::find(targets, target) == targets.end())
+                targets.push_back(target);
+        }
+
+        for (auto target : targets)
+        {
+            result.emplace_back(target, vertex, 0);
+            endpoints.push_back(target);
+            endpoints.push_back(vertex);
+        }
+    }
+
+    AssignUniqueWeights(result, g);
+    return result;
+}
+} // namespace Utils
@@ -0,0 +1,114 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+inline size_t GetHardwareThreadsCount()
+{
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+// Splits [0, count) into contiguous chunks, one per thread. Calling thread processes the first chunk.
+// func(chunk_index, begin, end)
+template<typename Func>
+void ParallelFor(size_t count, size_t threads_count, Func&& func)
+{
+    threads_count     = std::clamp<size_t>(threads_count, 1, std::max<size_t>(count, 1));
+    const size_t step = (count + threads_count - 1) / threads_count;
+
+    std::vector<std::jthread> threads{};
+    threads.reserve(threads_count - 1);
+    for (size_t chunk = 1; chunk < threads_count; ++chunk)
+        threads.emplace_back([&func, chunk, step, count] { func(chunk, std::min(chunk * step, count), std::min((chunk + 1) * step, count)); });
+
+    func(size_t{0}, size_t{0}, std::min(step, count));
+}
+
+// Same chunks as above, one per thread of pool and calling thread: repeated loops reuse workers of the pool instead of
+// starting new threads. Calling thread processes the first chunk, then helps with the rest
+template<typename Func>
+void ParallelFor(ThreadPool& pool, size_t count, Func&& func)
+{
+    const size_t threads_count = std::clamp<size_t>(pool.GetWorkersCount() + 1, 1, std::max<size_t>(count, 1));
+    const size_t step          = (count + threads_count - 1) / threads_count;
+
+    TaskGroup group{pool};
+    for (size_t chunk = 1; chunk < threads_count; ++chunk)
+        group.Run([&func, chunk, step, count] { func(chunk, std::min(chunk * step, count), std::min((chunk + 1) * step, count)); });
+
+    func(size_t{0}, size_t{0}, std::min(step, count));
+    group.Wait();
+}
+
+// Sorts contiguous chunks in parallel, then merges neighbour chunks pairwise, merges of one round run in parallel too.
+// Not stable. Ranges shorter than min_chunk per thread use less threads
+template<typename Itr, typename Compare>
+void ParallelSort(Itr begin, Itr end, size_t threads_count, Compare comp, size_t min_chunk = 1 << 14)
+{
+    const auto count = static_cast<size_t>(std::distance(begin, end));
+    threads_count    = std::clamp<size_t>(threads_count, 1, std::max<size_t>(count / std::max<size_t>(min_chunk, 1), 1));
+    if (threads_count == 1)
+        return std::sort(begin, end, comp);
+
+    // Same chunks as ParallelFor creates
+    const size_t        step = (count + threads_count - 1) / threads_count;
+    std::vector<size_t> bounds(threads_count + 1);
+    for (size_t chunk = 0; chunk <= threads_count; ++chunk)
+        bounds[chunk] = std::min(chunk * step, count);
+
+    ParallelFor(count, threads_count, [&](size_t, size_t chunk_begin, size_t chunk_end) { std::sort(begin + chunk_begin, begin + chunk_end, comp); });
+
+    for (size_t width = 1; width < threads_count; width *= 2)
+    {
+        const size_t pairs = (threads_count + 2 * width - 1) / (2 * width);
+        ParallelFor(pairs, pairs, [&](size_t, size_t first_pair, size_t last_pair)
+        {
+            for (size_t pair = first_pair; pair < last_pair; ++pair)
+            {
+                const auto left   = pair * 2 * width;
+                const auto middle = std::min(left + width, threads_count);
+                const auto right  = std::min(left + 2 * width, threads_count);
+                std::inplace_merge(begin + bounds[left], begin + bounds[middle], begin + bounds[right], comp);
+            }
+        });
+    }
+}
+
+template<typename T>
+void AtomicMin(std::atomic<T>& target, T value)
+{
+    T current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) { }
+}
+} // namespace Utils
@@ -0,0 +1,90 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Profiler.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Utils::Profiler::Details
+{
+HardwareCounters::HardwareCounters()
+{
+#if defined(__linux__)
+    const std::array<uint64_t, 4> configs{PERF_COUNT_HW_CPU_CYCLES,
+                                          PERF_COUNT_HW_INSTRUCTIONS,
+                                          PERF_COUNT_HW_CACHE_MISSES,
+                                          PERF_COUNT_HW_BRANCH_MISSES};
+    for (size_t i = 0; i < configs.size(); ++i)
+    {
+        perf_event_attr attr{};
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.size           = sizeof(attr);
+        attr.config         = configs[i];
+        attr.read_format    = PERF_FORMAT_GROUP;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.disabled       = i == 0 ? 1 : 0;
+
+        const auto fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : m_fds[0], 0));
+        if (fd < 0)
+        {
+            Close();
+            return;
+        }
+        m_fds[i] = fd;
+    }
+    ioctl(m_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+Counters HardwareCounters::Read() const
+{
+#if defined(__linux__)
+    if (IsAvailable())
+    {
+        // PERF_FORMAT_GROUP layout: count of events and their values
+        std::array<uint64_t, 5> values{};
+        if (read(m_fds[0], values.data(), sizeof(values)) == static_cast<ssize_t>(sizeof(values)))
+            return Counters{values[1], values[2], values[3], values[4]};
+    }
+#endif
+    return {};
+}
+
+void HardwareCounters::Close()
+{
+#if defined(__linux__)
+    for (auto& fd : m_fds)
+    {
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+#endif
+}
+} // namespace Utils::Profiler::Details
@@ -0,0 +1,299 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Hierarchical profiler of phase scopes (UTILS_PROFILE_SCOPE of Common.h, compiled in only if PROFILING_ENABLED is
+// defined): nested scopes are aggregated per thread into a tree of call paths, reports merge trees of all threads by
+// path. Every scope collects calls and nanoseconds of wall time and, if they are requested and the kernel allows them,
+// hardware counters of perf_event_open. Reading of counters costs a syscall per scope boundary, so they are meant for
+// coarse scopes and budget checks, not for absolute timings. Profiling is disabled at run time by default, then
+// compiled in scopes cost one relaxed atomic load. Report and Reset must not run
+// concurrently with profiled code
+namespace Utils::Profiler
+{
+struct Counters
+{
+    uint64_t cycles{};
+    uint64_t instructions{};
+    uint64_t llc_misses{};
+    uint64_t branch_misses{};
+
+    Counters& operator+=(const Counters& other)
+    {
+        cycles += other.cycles;
+        instructions += other.instructions;
+        llc_misses += other.llc_misses;
+        branch_misses += other.branch_misses;
+        return *this;
+    }
+};
+
+struct ScopeStats
+{
+    uint64_t calls{};
+    uint64_t nanoseconds{};
+    Counters counters{};
+    bool     has_counters{}; // false if hardware counters were not requested or not available
+
+    double GetSeconds() const { return static_cast<double>(nanoseconds) / 1e9; }
+    double GetIpc() const { return counters.cycles ? static_cast<double>(counters.instructions) / static_cast<double>(counters.cycles) : 0.0; }
+    // Per thousand instructions
+    double GetLlcMpki() const { return counters.instructions ? 1000.0 * static_cast<double>(counters.llc_misses) / static_cast<double>(counters.instructions) : 0.0; }
+    double GetBranchMpki() const { return counters.instructions ? 1000.0 * static_cast<double>(counters.branch_misses) / static_cast<double>(counters.instructions) : 0.0; }
+
+    ScopeStats& operator+=(const ScopeStats& other)
+    {
+        calls += other.calls;
+        nanoseconds += other.nanoseconds;
+        counters += other.counters;
+        has_counters = has_counters || other.has_counters;
+        return *this;
+    }
+};
+
+// Scopes by path of names joined by '/', for example "MSF/BoruvkaPhase"
+class Report
+{
+public:
+    explicit Report(std::map<std::string, ScopeStats> scopes = {})
+        : m_scopes{std::move(scopes)} {}
+
+    const std::map<std::string, ScopeStats>& GetScopes() const { return m_scopes; }
+
+    // Sum over all paths ending with name. Scopes nested into a scope with the same name are skipped, they are already
+    // included into the outer one
+    ScopeStats Total(std::string_view name) const
+    {
+        ScopeStats result{};
+        for (const auto& [path, stats] : m_scopes)
+        {
+            const auto leaf_begin = path.rfind('/') == std::string::npos ? 0 : path.rfind('/') + 1;
+            if (std::string_view{path}.substr(leaf_begin) != name)
+                continue;
+
+            bool nested = false;
+            for (size_t begin = 0; begin < leaf_begin && !nested; begin = path.find('/', begin) + 1)
+                nested = std::string_view{path}.substr(begin, path.find('/', begin) - begin) == name;
+            if (!nested)
+                result += stats;
+        }
+        return result;
+    }
+
+private:
+    std::map<std::string, ScopeStats> m_scopes;
+};
+
+namespace Details
+{
+// Group of hardware counters of calling thread, values are zeros if perf_event_open is not available
+class HardwareCounters
+{
+public:
+    HardwareCounters();
+    HardwareCounters(const HardwareCounters&)            = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+    ~HardwareCounters() { Close(); }
+
+    bool     IsAvailable() const { return m_fds[0] >= 0; }
+    Counters Read() const;
+
+private:
+    void Close();
+
+    std::array<int, 4> m_fds{-1, -1, -1, -1};
+};
+
+struct Node
+{
+    std::string                        name;
+    Node*                              parent{};
+    std::vector<std::unique_ptr<Node>> children{};
+    ScopeStats                         stats{};
+
+    Node* GetChild(std::string_view child_name)
+    {
+        for (auto& child : children)
+            if (child->name == child_name)
+                return child.get();
+        children.push_back(std::make_unique<Node>(Node{std::string{child_name}, this}));
+        return children.back().get();
+    }
+};
+
+// Call tree of one thread. Counters are closed when thread exits, collected data is kept till Reset
+struct ThreadProfile
+{
+    Node                              root{};
+    Node*                             current{&root};
+    std::unique_ptr<HardwareCounters> hardware{};
+};
+
+class Registry
+{
+public:
+    static Registry& Instance()
+    {
+        static Registry s_registry{};
+        return s_registry;
+    }
+
+    bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    bool IsHardwareRequested() const { return m_hardware.load(std::memory_order_relaxed); }
+
+    void Enable(bool hardware_counters)
+    {
+        m_hardware = hardware_counters;
+        m_enabled  = true;
+    }
+    void Disable() { m_enabled = false; }
+
+    ThreadProfile& GetThreadProfile()
+    {
+        // Owner of thread is registry, handle only closes counters of finished thread
+        struct Handle
+        {
+            ThreadProfile* profile{};
+            ~Handle()
+            {
+                if (profile)
+                    profile->hardware.reset();
+            }
+        };
+        thread_local Handle s_handle{};
+        if (!s_handle.profile)
+        {
+            std::lock_guard lock{m_mutex};
+            s_handle.profile = m_profiles.emplace_back(std::make_unique<ThreadProfile>()).get();
+        }
+        return *s_handle.profile;
+    }
+
+    Report GetReport()
+    {
+        std::lock_guard                   lock{m_mutex};
+        std::map<std::string, ScopeStats> scopes{};
+        for (const auto& profile : m_profiles)
+            Collect(profile->root, "", scopes);
+        return Report{std::move(scopes)};
+    }
+
+    // Drops collected data of all threads, scopes which are open now must not be closed after it
+    void Reset()
+    {
+        std::lock_guard lock{m_mutex};
+        for (auto& profile : m_profiles)
+        {
+            profile->root.children.clear();
+            profile->current = &profile->root;
+        }
+    }
+
+private:
+    Registry() = default;
+
+    static void Collect(const Node& node, const std::string& prefix, std::map<std::string, ScopeStats>& out)
+    {
+        for (const auto& child : node.children)
+        {
+            const auto path = prefix.empty() ? child->name : prefix + "/" + child->name;
+            out[path] += child->stats;
+            Collect(*child, path, out);
+        }
+    }
+
+    std::atomic<bool>                           m_enabled{false};
+    std::atomic<bool>                           m_hardware{false};
+    std::mutex                                  m_mutex{};
+    std::vector<std::unique_ptr<ThreadProfile>> m_profiles{};
+};
+// Adds time and counters from construction till destruction to node of current call path of the thread
+class Frame
+{
+public:
+    explicit Frame(std::string_view name)
+    {
+        auto& registry = Registry::Instance();
+        if (!registry.IsEnabled())
+            return;
+
+        m_profile = &registry.GetThreadProfile();
+        if (registry.IsHardwareRequested() && !m_profile->hardware)
+            m_profile->hardware = std::make_unique<HardwareCounters>();
+
+        m_node             = m_profile->current->GetChild(name);
+        m_profile->current = m_node;
+        if (m_profile->hardware && m_profile->hardware->IsAvailable())
+            m_counters = m_profile->hardware->Read();
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    ~Frame()
+    {
+        if (!m_profile)
+            return;
+
+        const auto end = std::chrono::steady_clock::now();
+        auto&      stats = m_node->stats;
+        ++stats.calls;
+        stats.nanoseconds += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_start).count());
+        if (m_profile->hardware && m_profile->hardware->IsAvailable())
+        {
+            const auto counters = m_profile->hardware->Read();
+            stats.counters += Counters{counters.cycles - m_counters.cycles,
+                                       counters.instructions - m_counters.instructions,
+                                       counters.llc_misses - m_counters.llc_misses,
+                                       counters.branch_misses - m_counters.branch_misses};
+            stats.has_counters = true;
+        }
+        m_profile->current = m_node->parent;
+    }
+
+    Frame(const Frame&)            = delete;
+    Frame& operator=(const Frame&) = delete;
+
+private:
+    ThreadProfile*                        m_profile{};
+    Node*                                 m_node{};
+    Counters                              m_counters{};
+    std::chrono::steady_clock::time_point m_start{};
+};
+} // namespace Details
+
+inline void   Enable(bool hardware_counters = false) { Details::Registry::Instance().Enable(hardware_counters); }
+inline void   Disable() { Details::Registry::Instance().Disable(); }
+inline void   Reset() { Details::Registry::Instance().Reset(); }
+inline Report GetReport() { return Details::Registry::Instance().GetReport(); }
+} // namespace Utils::Profiler
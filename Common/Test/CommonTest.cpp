@@ -0,0 +1,130 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <Common.h>
+#include <TournamentTree.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+TEST(TournamentTree, MatchesSequentialScan)
+{
+    std::mt19937                          g{1};
+    std::uniform_int_distribution<size_t> key_dis{0, 20};
+    std::uniform_int_distribution<size_t> leaf_dis{0, 12};
+
+    std::vector<std::optional<size_t>> keys(5);
+    Utils::TournamentTree<size_t>      tree{keys.size()};
+    EXPECT_EQ(tree.Top(), tree.npos);
+
+    for (size_t step = 0; step < 1000; ++step)
+    {
+        const auto leaf = leaf_dis(g);
+        if (leaf >= keys.size())
+            keys.resize(leaf + 1);
+
+        keys[leaf] = key_dis(g) % 4 ? std::optional{key_dis(g)} : std::nullopt;
+        tree.Update(leaf, keys[leaf]);
+
+        size_t expected = tree.npos;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            if (keys[i] && (expected == tree.npos || *keys[i] < *keys[expected]))
+                expected = i;
+        }
+        ASSERT_EQ(tree.Top(), expected);
+    }
+}
+
+TEST(Trace, RingBufferKeepsLatestEvents)
+{
+    Utils::Trace::ThreadBuffer buffer{1};
+    const auto                 count = Utils::Trace::ThreadBuffer::capacity + 10;
+    for (uint64_t i = 0; i < count; ++i)
+        buffer.Push(Utils::Trace::Event{"event", i, 1});
+
+    std::vector<uint64_t> starts{};
+    buffer.ForEach([&](const Utils::Trace::Event& event) { starts.push_back(event.start_ns); });
+    ASSERT_EQ(starts.size(), Utils::Trace::ThreadBuffer::capacity);
+    EXPECT_EQ(starts.front(), 10);
+    EXPECT_EQ(starts.back(), count - 1);
+    EXPECT_TRUE(std::ranges::is_sorted(starts));
+}
+
+TEST(Trace, WritesEventsOfAllThreads)
+{
+    Utils::ClearTrace();
+    {
+        Utils::Trace::Scope outer{"TraceTestOuter"};
+        std::thread         worker{[] { Utils::Trace::Scope inner{"TraceTestWorker"}; }};
+        worker.join();
+    }
+
+    std::stringstream out{};
+    Utils::WriteChromeTrace(out);
+    const auto trace = out.str();
+    EXPECT_THAT(trace, ::testing::HasSubstr("\"traceEvents\""));
+    EXPECT_THAT(trace, ::testing::HasSubstr("{\"name\": \"TraceTestOuter\", \"ph\": \"X\""));
+    EXPECT_THAT(trace, ::testing::HasSubstr("{\"name\": \"TraceTestWorker\", \"ph\": \"X\""));
+}
+
+TEST(Profiler, AggregatesNestedScopesOfAllThreads)
+{
+    Utils::Profiler::Reset();
+    Utils::Profiler::Enable();
+    for (size_t i = 0; i < 3; ++i)
+    {
+        UTILS_PROFILE_SCOPE("Outer");
+        UTILS_PROFILE_SCOPE("Inner");
+        {
+            UTILS_PROFILE_SCOPE("Outer");
+        }
+    }
+    std::thread{[] { UTILS_PROFILE_SCOPE("Inner"); }}.join();
+    Utils::Profiler::Disable();
+    {
+        UTILS_PROFILE_SCOPE("Outer");
+    }
+
+    const auto report = Utils::Profiler::GetReport();
+    const auto& scopes = report.GetScopes();
+    ASSERT_TRUE(scopes.contains("Outer/Inner/Outer"));
+    EXPECT_EQ(scopes.at("Outer").calls, 3);
+    EXPECT_EQ(scopes.at("Outer/Inner").calls, 3);
+    EXPECT_EQ(scopes.at("Inner").calls, 1);
+    EXPECT_GE(scopes.at("Outer").nanoseconds, scopes.at("Outer/Inner").nanoseconds);
+
+    // Nested scope with the same name is already included into the outer one
+    EXPECT_EQ(report.Total("Outer").calls, 3);
+    EXPECT_EQ(report.Total("Inner").calls, 4);
+    EXPECT_EQ(report.Total("Missing").calls, 0);
+
+    Utils::Profiler::Reset();
+    EXPECT_TRUE(Utils::Profiler::GetReport().GetScopes().empty());
+}
@@ -0,0 +1,209 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Utils
+{
+// Work-stealing pool: each worker owns a deque, pushes and pops its own tasks from the back and steals the oldest
+// tasks from the front of other deques. Tasks submitted from outside of the pool go to a shared deque.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t workers_count)
+    {
+        m_queues.reserve(workers_count + 1);
+        for (size_t i = 0; i <= workers_count; ++i)
+            m_queues.emplace_back(std::make_unique<Queue>());
+
+        m_workers.reserve(workers_count);
+        for (size_t i = 0; i < workers_count; ++i)
+            m_workers.emplace_back([this, i](std::stop_token stop) { WorkerLoop(i, stop); });
+    }
+
+    ThreadPool(const ThreadPool& other)            = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+
+    ~ThreadPool()
+    {
+        for (auto& worker : m_workers)
+            worker.request_stop();
+        m_workers.clear();
+    }
+
+    size_t GetWorkersCount() const { return m_workers.size(); }
+
+    void Submit(std::function<void()> task)
+    {
+        {
+            auto& queue = *m_queues[GetOwnQueueIndex()];
+            std::scoped_lock lock{queue.mutex};
+            queue.tasks.push_back(std::move(task));
+        }
+        m_pending_count.fetch_add(1);
+        {
+            std::scoped_lock lock{m_sleep_mutex};
+        }
+        m_wake_up.notify_one();
+    }
+
+    // Executes one pending task if any. Used by threads waiting for results to help instead of blocking
+    bool TryRunPendingTask()
+    {
+        auto task = Pop();
+        if (!task)
+            return false;
+        task();
+        return true;
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex                        mutex{};
+        std::deque<std::function<void()>> tasks{};
+    };
+
+    size_t GetOwnQueueIndex() const { return s_current_pool == this ? s_current_index : m_queues.size() - 1; }
+
+    std::function<void()> Pop()
+    {
+        const auto own = GetOwnQueueIndex();
+        for (size_t shift = 0; shift < m_queues.size(); ++shift)
+        {
+            auto&            queue = *m_queues[(own + shift) % m_queues.size()];
+            std::scoped_lock lock{queue.mutex};
+            if (queue.tasks.empty())
+                continue;
+
+            std::function<void()> task{};
+            if (shift == 0)
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            m_pending_count.fetch_sub(1);
+            return task;
+        }
+        return {};
+    }
+
+    void WorkerLoop(size_t index, std::stop_token stop)
+    {
+        s_current_pool  = this;
+        s_current_index = index;
+        while (!stop.stop_requested())
+        {
+            if (TryRunPendingTask())
+                continue;
+
+            std::unique_lock lock{m_sleep_mutex};
+            m_wake_up.wait(lock, stop, [&] { return m_pending_count.load() > 0; });
+        }
+    }
+
+private:
+    static inline thread_local const ThreadPool* s_current_pool  = nullptr;
+    static inline thread_local size_t            s_current_index = 0;
+
+    std::vector<std::unique_ptr<Queue>> m_queues{}; // last one is for external threads
+    std::atomic<size_t>                 m_pending_count{0};
+    std::mutex                          m_sleep_mutex{};
+    std::condition_variable_any         m_wake_up{};
+    std::vector<std::jthread>           m_workers{};
+};
+
+// Set of tasks to wait for. Waiting thread executes pending tasks of the pool, so nested groups never deadlock.
+class TaskGroup
+{
+public:
+    explicit TaskGroup(ThreadPool& pool)
+        : m_pool{pool} {}
+
+    TaskGroup(const TaskGroup& other)            = delete;
+    TaskGroup& operator=(const TaskGroup& other) = delete;
+
+    ~TaskGroup() { WaitAll(); }
+
+    void Run(std::function<void()> task)
+    {
+        m_pending_count.fetch_add(1);
+        m_pool.Submit([this, task = std::move(task)]
+        {
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                std::scoped_lock lock{m_exception_mutex};
+                if (!m_exception)
+                    m_exception = std::current_exception();
+            }
+            m_pending_count.fetch_sub(1);
+        });
+    }
+
+    // Rethrows the first exception thrown by tasks
+    void Wait()
+    {
+        WaitAll();
+        if (m_exception)
+            std::rethrow_exception(std::exchange(m_exception, nullptr));
+    }
+
+private:
+    void WaitAll()
+    {
+        while (m_pending_count.load() != 0)
+        {
+            if (!m_pool.TryRunPendingTask())
+                std::this_thread::yield();
+        }
+    }
+
+private:
+    ThreadPool&         m_pool;
+    std::atomic<size_t> m_pending_count{0};
+    std::mutex          m_exception_mutex{};
+    std::exception_ptr  m_exception{};
+};
+} // namespace Utils
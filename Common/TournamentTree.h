@@ -0,0 +1,95 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace Utils
+{
+// Winner tree over leaves 0..n-1 with optional keys: update of one leaf and search of minimal one are O(log n).
+// Among equal keys the leaf with lower index wins, the same as sequential scan with strict comparison picks.
+template<typename Key, typename Compare = std::less<Key>>
+class TournamentTree
+{
+public:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    TournamentTree() = default;
+    explicit TournamentTree(size_t leaves_count) { Reserve(leaves_count); }
+
+    // Leaves out of range are added as empty ones
+    void Update(size_t leaf, std::optional<Key> key)
+    {
+        if (leaf >= m_capacity)
+            Reserve(leaf + 1);
+
+        m_keys[leaf] = std::move(key);
+
+        size_t node     = m_capacity + leaf;
+        m_winners[node] = m_keys[leaf] ? leaf : npos;
+        for (node /= 2; node >= 1; node /= 2)
+            m_winners[node] = Winner(m_winners[node * 2], m_winners[node * 2 + 1]);
+    }
+
+    // npos if all leaves are empty
+    size_t                    Top() const { return m_capacity ? m_winners[1] : npos; }
+    const std::optional<Key>& Get(size_t leaf) const { return m_keys[leaf]; }
+    size_t                    GetCapacity() const { return m_capacity; }
+
+private:
+    size_t Winner(size_t left, size_t right) const
+    {
+        if (left == npos)
+            return right;
+        if (right == npos)
+            return left;
+        return Compare{}(*m_keys[right], *m_keys[left]) ? right : left;
+    }
+
+    void Reserve(size_t leaves_count)
+    {
+        size_t capacity = 1;
+        while (capacity < leaves_count)
+            capacity *= 2;
+        if (capacity <= m_capacity)
+            return;
+
+        m_capacity = capacity;
+        m_keys.resize(m_capacity);
+        m_winners.assign(m_capacity * 2, npos);
+        for (size_t leaf = 0; leaf < m_capacity; ++leaf)
+            m_winners[m_capacity + leaf] = m_keys[leaf] ? leaf : npos;
+        for (size_t node = m_capacity - 1; node >= 1; --node)
+            m_winners[node] = Winner(m_winners[node * 2], m_winners[node * 2 + 1]);
+    }
+
+private:
+    std::vector<std::optional<Key>> m_keys{};
+    std::vector<size_t>             m_winners{}; // 1-based heap layout, leaves start from m_capacity
+    size_t                          m_capacity{};
+};
+} // namespace Utils
@@ -0,0 +1,125 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <AllocTracker.h>
+#include <CSRGraph.h>
+#include <Common.h>
+#include <Generators.h>
+#include <Graph.h>
+#include <Parallel.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+
+// Live heap bytes measure footprint of each layout
+UTILS_DEFINE_ALLOCATION_TRACKING();
+
+static size_t GetLiveBytes() { return Utils::Alloc::GetReport().GetTotal().live_bytes; }
+
+template<typename Func>
+static double MeasureSeconds(Func&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::string ToString(std::optional<double> value, int precision)
+{
+    if (!value)
+        return "-";
+    std::ostringstream stream{};
+    stream << std::fixed << std::setprecision(precision) << *value;
+    return stream.str();
+}
+
+static void PrintRow(const std::string& name, std::optional<double> bytes_per_edge, std::optional<double> scan_edges_per_second, double boruvka_seconds)
+{
+    std::cout << std::left << std::setw(12) << name
+              << std::right << std::setw(18) << ToString(bytes_per_edge, 1)
+              << std::setw(22) << ToString(scan_edges_per_second, 0)
+              << std::setw(16) << ToString(boruvka_seconds, 3) << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    const size_t n            = argc > 1 ? std::stoull(argv[1]) : 200000;
+    const double average_degree = argc > 2 ? std::stod(argv[2]) : 10.0;
+    const size_t scans        = argc > 3 ? std::stoull(argv[3]) : 10;
+    const size_t threads      = argc > 4 ? std::stoull(argv[4]) : Utils::GetHardwareThreadsCount();
+
+    const auto   edges = Utils::ErdosRenie(n, average_degree / static_cast<double>(n));
+    const double m     = static_cast<double>(edges.size());
+    std::cout << "V: " << n << " E: " << edges.size() << " scans: " << scans << std::endl;
+    std::cout << std::left << std::setw(12) << "layout"
+              << std::right << std::setw(18) << "bytes/edge"
+              << std::setw(22) << "scan edges/s"
+              << std::setw(16) << "boruvka, s" << std::endl;
+
+    {
+        const auto   before = GetLiveBytes();
+        Graph::Graph graph{edges};
+        const auto   bytes = GetLiveBytes() - before;
+
+        size_t checksum = 0;
+        const auto scan = MeasureSeconds([&]
+        {
+            for (size_t i = 0; i < scans; ++i)
+                graph.ForValidEdges([&](const Graph::Details::Edge& edge, size_t, size_t) { checksum += edge.w; });
+        });
+        const auto boruvka = MeasureSeconds([&] { graph.BoruvkaPhase(std::numeric_limits<uint32_t>::max()); });
+
+        PrintRow("Graph", static_cast<double>(bytes) / m, m * static_cast<double>(scans) / scan, boruvka);
+        if (!checksum)
+            std::cout << "Empty graph" << std::endl;
+    }
+
+    {
+        Graph::Graph graph{edges};
+        const auto   boruvka = MeasureSeconds([&] { graph.BoruvkaPhase(std::numeric_limits<uint32_t>::max(), nullptr, threads); });
+        PrintRow("Graph x" + std::to_string(threads), {}, {}, boruvka);
+    }
+
+    {
+        const auto      before = GetLiveBytes();
+        Graph::CSRGraph graph{edges};
+        const auto      bytes = GetLiveBytes() - before;
+
+        size_t checksum = 0;
+        const auto scan = MeasureSeconds([&]
+        {
+            for (size_t i = 0; i < scans; ++i)
+                graph.ForEachEdge([&](size_t, size_t, size_t w, size_t) { checksum += w; });
+        });
+        const auto boruvka = MeasureSeconds([&] { graph.BoruvkaPhase(std::numeric_limits<uint32_t>::max()); });
+
+        PrintRow("CSRGraph", static_cast<double>(bytes) / m, m * static_cast<double>(scans) / scan, boruvka);
+        if (!checksum)
+            std::cout << "Empty graph" << std::endl;
+    }
+    return 0;
+}
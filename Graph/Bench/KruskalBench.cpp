@@ -0,0 +1,84 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <Generators.h>
+#include <Kruskal.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <string>
+
+template<typename Func>
+static double MeasureSeconds(Func&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t n              = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1])) : 100000;
+    const double   average_degree = argc > 2 ? std::stod(argv[2]) : 32.0;
+    const size_t   repeats        = argc > 3 ? std::stoull(argv[3]) : 3;
+
+    const auto edges = Utils::ErdosRenie(n, average_degree / static_cast<double>(n));
+    std::cout << "V: " << n << " E: " << edges.size() << " repeats: " << repeats << std::endl;
+
+    // Both variants reorder edges, so every run gets fresh graph
+    const auto make_graph = [&]
+    {
+        Kruskal::Graph graph{n, edges.size()};
+        size_t         index = 0;
+        for (const auto& [i, j, w] : edges)
+            graph.addEdge(i, j, w, index++);
+        return graph;
+    };
+
+    double kruskal_seconds        = 0;
+    double filter_kruskal_seconds = 0;
+    size_t kruskal_size           = 0;
+    size_t filter_kruskal_size    = 0;
+    for (size_t i = 0; i < repeats; ++i)
+    {
+        auto kruskal = make_graph();
+        kruskal_seconds += MeasureSeconds([&] { kruskal_size = kruskal.kruskalMST().size(); });
+
+        auto filter_kruskal = make_graph();
+        filter_kruskal_seconds += MeasureSeconds([&] { filter_kruskal_size = filter_kruskal.filterKruskalMST().size(); });
+    }
+
+    std::cout << std::left << std::setw(16) << "algorithm"
+              << std::right << std::setw(14) << "mst edges"
+              << std::setw(14) << "seconds" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << std::left << std::setw(16) << "Kruskal"
+              << std::right << std::setw(14) << kruskal_size
+              << std::setw(14) << kruskal_seconds / static_cast<double>(repeats) << std::endl;
+    std::cout << std::left << std::setw(16) << "Filter-Kruskal"
+              << std::right << std::setw(14) << filter_kruskal_size
+              << std::setw(14) << filter_kruskal_seconds / static_cast<double>(repeats) << std::endl;
+    return 0;
+}
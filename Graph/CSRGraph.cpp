@@ -0,0 +1,183 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "CSRGraph.h"
+
+#include <Common.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace Graph
+{
+CSRGraph::CSRGraph(const std::vector<std::tuple<size_t, size_t, size_t>>& edges)
+{
+    size_t max_vertex = 0;
+    for (const auto& [i, j, w] : edges)
+        max_vertex = std::max({max_vertex, i, j});
+    if (max_vertex > std::numeric_limits<uint32_t>::max() || edges.size() > std::numeric_limits<uint32_t>::max())
+        throw std::length_error("CSRGraph: vertices and edges must fit into 32 bits");
+
+    const size_t        vertices = edges.empty() ? 0 : max_vertex + 1;
+    std::vector<size_t> degree(vertices, 0);
+    for (const auto& [i, j, w] : edges)
+    {
+        // Same filtering as Graph::AddEdge
+        if (!w || i == j)
+            continue;
+        ++degree[i];
+        ++degree[j];
+    }
+
+    m_offsets.resize(vertices + 1, 0);
+    std::inclusive_scan(degree.cbegin(), degree.cend(), m_offsets.begin() + 1);
+    m_vertices_count = static_cast<size_t>(std::ranges::count_if(degree, [](size_t d) { return d != 0; }));
+
+    m_targets.resize(m_offsets.back());
+    m_weights.resize(m_offsets.back());
+    m_edge_ids.resize(m_offsets.back());
+
+    std::vector<size_t> position{m_offsets.cbegin(), std::prev(m_offsets.cend())};
+    uint32_t            index = 0;
+    for (const auto& [i, j, w] : edges)
+    {
+        if (!w)
+            continue;
+
+        // Graph keeps index for self-loops, they are never valid
+        if (i != j)
+        {
+            for (auto [from, to] : {std::pair{i, j}, std::pair{j, i}})
+            {
+                const auto pos  = position[from]++;
+                m_targets[pos]  = static_cast<uint32_t>(to);
+                m_weights[pos]  = w;
+                m_edge_ids[pos] = index;
+            }
+        }
+        ++index;
+    }
+
+    m_subsets = Utils::DisjointSets{vertices};
+}
+
+size_t CSRGraph::GetMemoryUsage() const
+{
+    return m_offsets.capacity() * sizeof(size_t) +
+           m_targets.capacity() * sizeof(uint32_t) +
+           m_weights.capacity() * sizeof(size_t) +
+           m_edge_ids.capacity() * sizeof(uint32_t) +
+           m_subsets.GetMemoryUsage();
+}
+
+std::list<size_t> CSRGraph::BoruvkaPhase(size_t count, bool* out_no_changes)
+{
+    UTILS_PROFILE_SCOPE("BoruvkaPhase");
+    constexpr auto      npos = std::numeric_limits<size_t>::max();
+    std::vector<size_t> cheapest_position_for_each_subset(m_subsets.GetCapacity(), npos);
+    std::list<size_t>   result{};
+
+    auto is_cheaper = [&](size_t pos, size_t than_pos)
+    {
+        return than_pos == npos || std::tie(m_weights[pos], m_edge_ids[pos]) < std::tie(m_weights[than_pos], m_edge_ids[than_pos]);
+    };
+
+    for (size_t round = 0; round < count; ++round)
+    {
+        if (round != 0)
+            std::ranges::fill(cheapest_position_for_each_subset, npos);
+
+        // Each edge is visited from both sides, so it is enough to update only subset of the source vertex
+        for (size_t v = 0; v < m_subsets.GetCapacity(); ++v)
+        {
+            const auto root = m_subsets.Find(v);
+            auto&      cheapest = cheapest_position_for_each_subset[root];
+            for (size_t pos = m_offsets[v]; pos < m_offsets[v + 1]; ++pos)
+            {
+                if (is_cheaper(pos, cheapest) && m_subsets.Find(m_targets[pos]) != root)
+                    cheapest = pos;
+            }
+        }
+
+        bool no_changes = true;
+        for (size_t root = 0; root < cheapest_position_for_each_subset.size(); ++root)
+        {
+            const auto pos = cheapest_position_for_each_subset[root];
+            if (pos == npos)
+                continue;
+
+            const auto i = m_subsets.Find(root);
+            const auto j = m_subsets.Find(m_targets[pos]);
+            if (i == j)
+                continue;
+
+            m_subsets.Union(i, j);
+            result.push_back(m_edge_ids[pos]);
+            no_changes = false;
+        }
+
+        if (no_changes)
+        {
+            if (out_no_changes)
+                *out_no_changes = true;
+            return result;
+        }
+    }
+    return result;
+}
+
+Graph CSRGraph::ToGraph() const
+{
+    // Keep original order of edges to get the same indexes and the same order of iteration
+    std::vector<std::tuple<size_t, size_t, size_t>> edges(GetEdgesCount());
+    std::vector<size_t>                             indexes(GetEdgesCount());
+    size_t                                          count = 0;
+    ForEachEdge([&](size_t i, size_t j, size_t w, size_t index)
+    {
+        edges[count]   = {i, j, w};
+        indexes[count] = index;
+        ++count;
+    });
+
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::sort(order, {}, [&](size_t pos) { return indexes[pos]; });
+
+    Graph result{};
+    for (auto pos : order)
+    {
+        auto [i, j, w] = edges[pos];
+        result.AddEdge(i, j, w, indexes[pos]);
+    }
+    return result;
+}
+
+Kruskal::Graph CSRGraph::ToKruskal() const
+{
+    Kruskal::Graph result{m_subsets.GetCapacity(), GetEdgesCount()};
+    ForEachEdge([&](size_t i, size_t j, size_t w, size_t index) { result.addEdge(i, j, w, index); });
+    return result;
+}
+} // namespace Graph
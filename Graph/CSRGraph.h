@@ -0,0 +1,79 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "Graph.h"
+#include "Kruskal.h"
+
+#include <DisjointSets.h>
+
+#include <cstdint>
+#include <list>
+#include <tuple>
+#include <vector>
+
+namespace Graph
+{
+// Immutable compressed sparse row storage. Each undirected edge is stored twice (u->v and v->u), edge index is the
+// same as Graph would assign for the same input.
+class CSRGraph
+{
+public:
+    CSRGraph() = default;
+    // Throws std::length_error if vertices or edges don't fit into 32-bit targets and edge ids
+    CSRGraph(const std::vector<std::tuple<size_t, size_t, size_t>>& edges);
+
+    size_t GetVerticesCount() const { return m_vertices_count; }
+    size_t GetEdgesCount() const { return m_targets.size() / 2; }
+    size_t GetMemoryUsage() const;
+
+    // Boruvka over contracted subsets, contraction is kept in internal union-find
+    std::list<size_t> BoruvkaPhase(size_t count = 1, bool* no_changes = nullptr);
+
+    template<typename Action>
+    void ForEachEdge(Action&& action) const
+    {
+        for (size_t v = 0; v + 1 < m_offsets.size(); ++v)
+        {
+            for (size_t pos = m_offsets[v]; pos < m_offsets[v + 1]; ++pos)
+            {
+                if (v < m_targets[pos])
+                    action(v, static_cast<size_t>(m_targets[pos]), m_weights[pos], static_cast<size_t>(m_edge_ids[pos]));
+            }
+        }
+    }
+
+    Graph          ToGraph() const;
+    Kruskal::Graph ToKruskal() const;
+
+private:
+    std::vector<size_t>   m_offsets{};  // vertex -> first position in targets, size is V+1
+    std::vector<uint32_t> m_targets{};
+    std::vector<size_t>   m_weights{};
+    std::vector<uint32_t> m_edge_ids{};
+    size_t                m_vertices_count{};
+
+    Utils::DisjointSets m_subsets{};
+};
+} // namespace Graph
@@ -22,8 +22,16 @@
 
 #include "Graph.h"
 
+#include <Common.h>
+#include <Parallel.h>
+
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <numeric>
 #include <ranges>
+#include <span>
 #include <stdexcept>
 
 namespace Graph
@@ -42,19 +50,78 @@ Graph::Graph(const std::vector<std::tuple<size_t, size_t, size_t>>& edges)
     for (auto& [i,j,w] : edges)
         AddEdge(i,j,w);
 }
+
+Graph::Graph(Graph& parent, std::span<const size_t> edge_indexes)
+    : m_store{parent.m_store}
+    , m_is_view{true}
+{
+    m_slots.reserve(edge_indexes.size());
+    for (const auto index : edge_indexes)
+        m_slots.push_back(m_store->index_to_slot.at(index));
+    std::ranges::sort(m_slots);
+    m_slots.erase(std::ranges::unique(m_slots).begin(), m_slots.end());
+
+    // Edges still reference original vertices, so they are kept too and linked with current roots of parent
+    std::vector<std::array<size_t, 2>> parent_roots(m_slots.size());
+    m_vertex_ids.reserve(m_slots.size() * 4);
+    for (size_t local_edge = 0; local_edge < m_slots.size(); ++local_edge)
+    {
+        const auto& edge         = GetLocalEdge(local_edge);
+        parent_roots[local_edge] = {parent.GetRoot(edge.i), parent.GetRoot(edge.j)};
+        m_vertex_ids.insert(m_vertex_ids.end(), {edge.i, edge.j, parent_roots[local_edge][0], parent_roots[local_edge][1]});
+    }
+    std::ranges::sort(m_vertex_ids);
+    m_vertex_ids.erase(std::ranges::unique(m_vertex_ids).begin(), m_vertex_ids.end());
+
+    m_subsets = Utils::DisjointSets{m_vertex_ids.size()};
+    m_incidence.resize(m_vertex_ids.size());
+    m_endpoints.resize(m_slots.size());
+    m_disabled.resize(m_slots.size(), false);
+    m_valid_edges.resize(m_slots.size());
+    std::iota(m_valid_edges.begin(), m_valid_edges.end(), 0);
+
+    for (size_t local_edge = 0; local_edge < m_slots.size(); ++local_edge)
+    {
+        const auto& edge = GetLocalEdge(local_edge);
+        const auto  i    = ToLocal(parent_roots[local_edge][0]);
+        const auto  j    = ToLocal(parent_roots[local_edge][1]);
+
+        // Original vertex is a singleton joined to bigger or equal set, so root of parent stays the root
+        m_subsets.Union(i, ToLocal(edge.i));
+        m_subsets.Union(j, ToLocal(edge.j));
+
+        m_endpoints[local_edge] = {i, j};
+        m_incidence[i].push_back(local_edge);
+        m_incidence[j].push_back(local_edge);
+        m_max_weight = std::max(m_max_weight, edge.w);
+        m_max_index  = std::max(m_max_index, edge.index);
+    }
+}
+
 void Graph::AddEdge(size_t i, size_t j, size_t w, std::optional<size_t> index)
 {
+    if (m_is_view)
+        throw std::logic_error("Edges could not be added to subgraph view");
+
     if (!w)
         return;
 
-    auto cur_index= index.value_or(m_edges.size());
-    m_edges.emplace(cur_index, Details::Edge(std::min(i, j), std::max(i,j), w, cur_index));
+    // Store is shared with subgraph views or copies of this graph, they must not see new edges
+    if (m_store.use_count() > 1)
+        m_store = std::make_shared<Details::EdgeStore>(*m_store);
+
+    const auto cur_index = index.value_or(m_store->edges.size());
+    const auto slot      = m_store->edges.size();
+    if (!m_store->index_to_slot.emplace(cur_index, slot).second)
+        return;
+
+    m_store->edges.emplace_back(std::min(i, j), std::max(i,j), w, cur_index);
+    m_max_weight = std::max(m_max_weight, w);
+    m_max_index  = std::max(m_max_index, cur_index);
 
     AddToVertexToSet(i);
     AddToVertexToSet(j);
-
-    m_subset_to_rank.try_emplace(i, 0);
-    m_subset_to_rank.try_emplace(j, 0);
+    AddLocalEdge(slot, i, j);
 }
 
 size_t Graph::GetEdgesCount()
@@ -75,153 +142,351 @@ size_t Graph::GetEdgesCount()
     return count;
 }
 
-std::list<size_t> Graph::BoruvkaPhase(size_t count, bool* out_no_changes)
+std::list<size_t> Graph::BoruvkaPhase(size_t count, bool* out_no_changes, size_t threads_count)
+{
+    if (threads_count <= 1)
+        return BoruvkaRounds(count, out_no_changes, nullptr);
+
+    // Rounds and loops of one phase share the workers
+    Utils::ThreadPool pool{threads_count - 1};
+    return BoruvkaRounds(count, out_no_changes, &pool);
+}
+
+std::list<size_t> Graph::BoruvkaPhase(size_t count, bool* out_no_changes, Utils::ThreadPool& pool)
+{
+    return BoruvkaRounds(count, out_no_changes, &pool);
+}
+
+std::list<size_t> Graph::BoruvkaRounds(size_t count, bool* out_no_changes, Utils::ThreadPool* pool)
 {
-    std::vector<std::optional<size_t>> cheapest_edge_for_each_vertex{};
-    cheapest_edge_for_each_vertex.resize(m_vertex_to_parent.size());
+    UTILS_PROFILE_SCOPE("BoruvkaPhase");
+    std::vector<size_t> cheapest_edge_for_each_vertex{};
+    cheapest_edge_for_each_vertex.resize(m_subsets.GetCapacity(), npos);
     std::list<size_t> result{};
     for (size_t i = 0; i < count; ++i)
     {
+        UTILS_TRACE_SCOPE("BoruvkaRound");
         if (i != 0)
-            std::fill(cheapest_edge_for_each_vertex.begin(), cheapest_edge_for_each_vertex.end(), std::nullopt);
+            std::fill(cheapest_edge_for_each_vertex.begin(), cheapest_edge_for_each_vertex.end(), npos);
+
+        if (!pool || !pool->GetWorkersCount() || !ParallelCheapestEdges(cheapest_edge_for_each_vertex, *pool))
+        {
+            ForValidLocalEdges([&](size_t local_edge, size_t i, size_t j)
+            {
+                const auto w = GetLocalEdge(local_edge).w;
+                for (const auto& subgraph : {i, j})
+                {
+                    auto& cheapest_edge = cheapest_edge_for_each_vertex[subgraph];
+                    if (cheapest_edge == npos || w < GetLocalEdge(cheapest_edge).w)
+                        cheapest_edge = local_edge;
+                }
+            });
+        }
+
+        if (!ContractCheapestEdges(cheapest_edge_for_each_vertex, result))
+        {
+            if (out_no_changes)
+                *out_no_changes = true;
+            return result;
+        }
+    }
+    return result;
+}
 
-        ForValidEdges([&](const Details::Edge& edge, size_t i, size_t j)
+bool Graph::ParallelCheapestEdges(std::vector<size_t>& out_cheapest, Utils::ThreadPool& pool)
+{
+    // Weight and local edge are packed into one atomic word: the minimum is the lightest edge with the lowest local
+    // index, the same edge as sequential scan over local edges in ascending order picks
+    constexpr uint64_t edge_bits = 32;
+    constexpr uint64_t edge_mask = (uint64_t{1} << edge_bits) - 1;
+    constexpr uint64_t none      = std::numeric_limits<uint64_t>::max();
+    if (m_max_weight >= (uint64_t{1} << (64 - edge_bits)) - 1 || m_slots.size() > edge_mask)
+        return false;
+
+    const size_t vertices_count = m_subsets.GetCapacity();
+
+    // Parallel pointer jumping over snapshot of union-find gives final root for each vertex without writes to it
+    std::vector<size_t> roots(vertices_count);
+    std::vector<size_t> next_roots(vertices_count);
+    Utils::ParallelFor(pool, vertices_count, [&](size_t, size_t begin, size_t end)
+    {
+        for (size_t v = begin; v < end; ++v)
+            roots[v] = m_subsets.GetParent(v);
+    });
+
+    for (bool changed = true; changed;)
+    {
+        std::atomic_bool any_changed{false};
+        Utils::ParallelFor(pool, vertices_count, [&](size_t, size_t begin, size_t end)
         {
-            for (const auto& subgraph : {i, j})
+            bool local_changed = false;
+            for (size_t v = begin; v < end; ++v)
             {
-                auto& cheapest_edge = cheapest_edge_for_each_vertex[subgraph];
-                if (!cheapest_edge.has_value() || edge.w < m_edges[cheapest_edge.value()].w)
-                    cheapest_edge.emplace(edge.index);
+                const auto parent = roots[v];
+                next_roots[v]     = parent == npos ? parent : roots[parent];
+                local_changed |= next_roots[v] != parent;
             }
+            if (local_changed)
+                any_changed = true;
         });
+        std::swap(roots, next_roots);
+        changed = any_changed;
+    }
+
+    std::vector<std::atomic<uint64_t>> cheapest(vertices_count);
+    Utils::ParallelFor(pool, vertices_count, [&](size_t, size_t begin, size_t end)
+    {
+        for (size_t v = begin; v < end; ++v)
+            cheapest[v].store(none, std::memory_order_relaxed);
+    });
 
-        bool no_changes = true;
-        for (auto& edge_index : cheapest_edge_for_each_vertex)
+    // Each thread compacts its own chunk of valid edges in place. Chunks beyond the end are empty
+    std::vector<std::array<size_t, 2>> valid_per_chunk(pool.GetWorkersCount() + 1, {0, 0}); // begin, valid count
+    Utils::ParallelFor(pool, m_valid_edges.size(), [&](size_t chunk, size_t begin, size_t end)
+    {
+        size_t valid_count = begin;
+        for (size_t k = begin; k < end; ++k)
         {
-            if (!edge_index.has_value())
+            const auto  local_edge = m_valid_edges[k];
+            const auto& endpoints  = m_endpoints[local_edge];
+            const auto  i          = roots[endpoints[0]];
+            const auto  j          = roots[endpoints[1]];
+            if (m_disabled[local_edge] || i == j)
                 continue;
 
-            auto itr = m_edges.find(edge_index.value());
-            if (itr == m_edges.cend())
-                continue;
+            m_valid_edges[valid_count++] = local_edge;
 
-            auto i = GetRoot(itr->second.i);
-            auto j = GetRoot(itr->second.j);
+            const auto key = (static_cast<uint64_t>(GetLocalEdge(local_edge).w) << edge_bits) | local_edge;
+            Utils::AtomicMin(cheapest[i], key);
+            Utils::AtomicMin(cheapest[j], key);
+        }
+        valid_per_chunk[chunk] = {begin, valid_count - begin};
+    });
 
-            m_edges.erase(itr);
+    size_t valid_count = 0;
+    for (const auto& [chunk_begin, chunk_valid] : valid_per_chunk)
+    {
+        const auto begin = m_valid_edges.begin() + static_cast<std::ptrdiff_t>(chunk_begin);
+        std::copy(begin, begin + static_cast<std::ptrdiff_t>(chunk_valid), m_valid_edges.begin() + static_cast<std::ptrdiff_t>(valid_count));
+        valid_count += chunk_valid;
+    }
+    m_valid_edges.resize(valid_count);
 
-            if (i == j)
-                continue;
+    for (size_t v = 0; v < vertices_count; ++v)
+    {
+        const auto key  = cheapest[v].load(std::memory_order_relaxed);
+        out_cheapest[v] = key == none ? npos : static_cast<size_t>(key & edge_mask);
+    }
+    return true;
+}
 
-            Union(i, j);
+bool Graph::ContractCheapestEdges(const std::vector<size_t>& cheapest, std::list<size_t>& result)
+{
+    bool changed = false;
+    for (const auto local_edge : cheapest)
+    {
+        if (local_edge == npos)
+            continue;
 
-            result.push_back(edge_index.value());
-            no_changes = false;
-        }
+        const auto& endpoints = m_endpoints[local_edge];
+        auto        i         = m_subsets.Find(endpoints[0]);
+        auto        j         = m_subsets.Find(endpoints[1]);
 
-        if (no_changes)
-        {
-            if (out_no_changes)
-                *out_no_changes = true;
-            return result;
-        }
+        // Same edge could be the cheapest one for both subsets
+        if (i == j)
+            continue;
+
+        UnionLocal(i, j);
+
+        result.push_back(GetLocalEdge(local_edge).index);
+        changed = true;
     }
-    return result;
+    return changed;
 }
 
 std::set<size_t> Graph::GetVertices() const
 {
+    // Vertex ids are ascending in local order
     std::set<size_t> result{};
-    for(auto& [v, r] : m_subset_to_rank)
-        result.emplace(v);
+    for (size_t v = 0; v < m_subsets.GetCapacity(); ++v)
+    {
+        if (m_subsets.IsRoot(v))
+            result.emplace_hint(result.end(), ToId(v));
+    }
     return result;
 }
 
 size_t Graph::GetRoot(size_t v)
 {
-    auto value = GetRootIfExists(v);
-    if (!value.has_value())
+    const auto root = GetRootIfExists(v);
+    if (!root.has_value())
         throw std::out_of_range("");
-    return value.value();
+    return root.value();
 }
 
 std::optional<size_t> Graph::GetRootIfExists(size_t v)
 {
-    if (v < m_vertex_to_parent.size())
-    {
-        if (m_vertex_to_parent[v].has_value() && v != m_vertex_to_parent[v])
-            m_vertex_to_parent[v] = GetRootIfExists(m_vertex_to_parent[v].value());
-        return m_vertex_to_parent[v];
-    }
-    return {};
+    const auto local_v = ToLocal(v);
+    if (!m_subsets.Contains(local_v))
+        return {};
+    return ToId(m_subsets.Find(local_v));
 }
 
 void Graph::Union(size_t i, size_t j)
 {
-    auto root_i_opt = GetRootIfExists(i); 
-    auto root_j_opt = GetRootIfExists(j);
-
-    if (!root_i_opt || !root_j_opt)
+    const auto local_i = ToLocal(i);
+    const auto local_j = ToLocal(j);
+    if (!m_subsets.Contains(local_i) || !m_subsets.Contains(local_j))
         return;
 
-    auto& root_i = root_i_opt.value();
-    auto& root_j = root_j_opt.value();
+    UnionLocal(local_i, local_j);
+}
+
+void Graph::UnionLocal(size_t u, size_t v)
+{
+    const auto root_u = m_subsets.Find(u);
+    const auto root_v = m_subsets.Find(v);
+    if (root_u == root_v)
+        return;
 
-    // merge smaller tree to larger one by comparing rank
-    const auto itr_i = m_subset_to_rank.find(root_i);
-    const auto itr_j = m_subset_to_rank.find(root_j);
-    if (itr_i->second < itr_j->second)
-    {
-        m_subset_to_rank.erase(itr_i);
-        m_vertex_to_parent[i] = root_j;
-    }
-    else if (itr_i->second > itr_j->second)
-    {
-        m_subset_to_rank.erase(itr_j);
-        m_vertex_to_parent[j] = root_i;
-    }
-    // If ranks are same
-    else
-    {
-        m_subset_to_rank.erase(itr_i);
-        m_vertex_to_parent[i] = root_j;
-        itr_j->second += 1;
-    } 
+    const auto root  = m_subsets.Union(root_u, root_v);
+    const auto child = root == root_u ? root_v : root_u;
+
+    // keep incidence of new root, always append shorter list to longer one
+    auto& from = m_incidence[child];
+    auto& to   = m_incidence[root];
+    if (from.size() > to.size())
+        std::swap(from, to);
+    to.insert(to.end(), from.cbegin(), from.cend());
+    from.clear();
+    from.shrink_to_fit();
 }
 
 void Graph::DisableEdge(size_t index)
 {
-    m_edges[index].disabled = true;
+    const auto itr = m_store->index_to_slot.find(index);
+    if (itr == m_store->index_to_slot.cend())
+        return;
+
+    const auto local_edge = ToLocalEdge(itr->second);
+    if (local_edge != npos)
+        m_disabled[local_edge] = true;
 }
 
-void Graph::ForValidEdges(std::function<void(const Details::Edge&, size_t i, size_t j)> action)
+template<typename Action>
+void Graph::ForValidLocalEdges(Action&& action)
 {
-    for (auto itr = m_edges.begin(); itr != m_edges.end();)
+    // Roots are searched in batches to overlap cache misses of union-find lookups
+    constexpr size_t              batch_size = 64;
+    std::array<size_t, batch_size>     edges{};
+    std::array<size_t, batch_size * 2> vertices{};
+    std::array<size_t, batch_size * 2> roots{};
+
+    size_t valid_count = 0;
+    for (size_t begin = 0; begin < m_valid_edges.size(); begin += batch_size)
     {
-        if (itr->second.disabled)
+        size_t count = 0;
+        for (size_t k = begin; k < std::min(begin + batch_size, m_valid_edges.size()); ++k)
         {
-            itr = m_edges.erase(itr);
-            continue;
+            const auto local_edge = m_valid_edges[k];
+            if (m_disabled[local_edge])
+                continue;
+
+            edges[count]            = local_edge;
+            vertices[count * 2]     = m_endpoints[local_edge][0];
+            vertices[count * 2 + 1] = m_endpoints[local_edge][1];
+            ++count;
         }
 
-        const auto i = GetRoot(itr->second.i);
-        const auto j = GetRoot(itr->second.j);
+        m_subsets.FindBatch(std::span{vertices.data(), count * 2}, roots);
 
-        if (i == j)
+        for (size_t k = 0; k < count; ++k)
         {
-            itr = m_edges.erase(itr);
-            continue;
+            const auto i = roots[k * 2];
+            const auto j = roots[k * 2 + 1];
+            if (m_disabled[edges[k]] || i == j)
+                continue;
+
+            m_valid_edges[valid_count++] = edges[k];
+            action(edges[k], i, j);
         }
+    }
+    m_valid_edges.resize(valid_count);
+}
+
+void Graph::ForValidEdges(std::function<void(const Details::Edge&, size_t i, size_t j)> action)
+{
+    ForValidLocalEdges([&](size_t local_edge, size_t i, size_t j) { action(GetLocalEdge(local_edge), ToId(i), ToId(j)); });
+}
+
+void Graph::ForValidEdgesOf(size_t v, std::function<void(const Details::Edge&, size_t i, size_t j)> action)
+{
+    const auto local_v = ToLocal(v);
+    if (!m_subsets.Contains(local_v))
+        return;
+
+    auto&  incidence = m_incidence[m_subsets.Find(local_v)];
+    size_t i{}, j{};
+    size_t valid_count = 0;
+    for (const auto local_edge : incidence)
+    {
+        if (!IsValidEdge(local_edge, i, j))
+            continue;
 
-        action(itr->second, i, j);
-        ++itr;
+        incidence[valid_count++] = local_edge;
+        action(GetLocalEdge(local_edge), ToId(i), ToId(j));
     }
+    incidence.resize(valid_count);
+}
+
+bool Graph::IsValidEdge(size_t local_edge, size_t& out_u, size_t& out_v)
+{
+    if (m_disabled[local_edge])
+        return false;
+
+    out_u = m_subsets.Find(m_endpoints[local_edge][0]);
+    out_v = m_subsets.Find(m_endpoints[local_edge][1]);
+    return out_u != out_v;
+}
+
+size_t Graph::ToLocal(size_t v) const
+{
+    if (!m_is_view)
+        return v;
+
+    const auto itr = std::ranges::lower_bound(m_vertex_ids, v);
+    if (itr == m_vertex_ids.cend() || *itr != v)
+        return npos;
+    return static_cast<size_t>(itr - m_vertex_ids.cbegin());
+}
+
+size_t Graph::ToLocalEdge(size_t slot) const
+{
+    if (!m_is_view)
+        return slot < m_slots.size() ? slot : npos;
+
+    const auto itr = std::ranges::lower_bound(m_slots, slot);
+    if (itr == m_slots.cend() || *itr != slot)
+        return npos;
+    return static_cast<size_t>(itr - m_slots.cbegin());
+}
+
+void Graph::AddLocalEdge(size_t slot, size_t u, size_t v)
+{
+    const auto local_edge = m_slots.size();
+    m_slots.push_back(slot);
+    m_endpoints.push_back({u, v});
+    m_disabled.push_back(false);
+    m_valid_edges.push_back(local_edge);
+
+    m_incidence[u].push_back(local_edge);
+    m_incidence[v].push_back(local_edge);
 }
 
 void Graph::AddToVertexToSet(size_t vertex)
 {
-    if (m_vertex_to_parent.size() <= vertex)
-        m_vertex_to_parent.resize(vertex+1);
-    m_vertex_to_parent[vertex] = vertex;
+    m_subsets.Add(vertex);
+    if (m_incidence.size() <= vertex)
+        m_incidence.resize(vertex + 1);
 }
 } // namespace Graph
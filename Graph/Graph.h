@@ -23,12 +23,19 @@
 #pragma once
 #include "GraphDetails.h"
 
+#include <DisjointSets.h>
+#include <ThreadPool.h>
+
+#include <array>
+#include <cstdint>
 #include <functional>
 #include <list>
 #include <map>
+#include <memory>
 #include <optional>
 #include <ranges>
 #include <set>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -41,29 +48,71 @@ public:
     Graph(const std::vector<std::vector<uint32_t>>& adjacency);
     Graph(const std::vector<std::tuple<size_t, size_t, size_t>>& edges);
 
+    // Subgraph view over edges of parent: edge store is shared, endpoints are mapped to current roots of parent.
+    // Union-find, incidence and disabled flags are local, so parent is not affected by changes of subgraph.
+    // Parent is used only during construction, edge store is kept alive by subgraph itself
+    Graph(Graph& parent, std::span<const size_t> edge_indexes);
+
+    // Only for graph which is not a subgraph view
     void AddEdge(size_t i, size_t j, size_t w, std::optional<size_t> index = std::nullopt);
     void Union(size_t i, size_t j);
     void DisableEdge(size_t index);
 
     size_t GetEdgesCount();
-    size_t GetTotalEdgesCount() const {return m_edges.size();};
-    size_t GetVerticesCount() const { return m_subset_to_rank.size(); }
+    size_t GetTotalEdgesCount() const {return m_valid_edges.size();};
+    size_t GetVerticesCount() const { return m_subsets.GetSetsCount(); }
+    size_t GetMaxWeight() const { return m_max_weight; }
+    size_t GetMaxIndex() const { return m_max_index; }
 
-    std::list<size_t>     BoruvkaPhase(size_t count = 1, bool* no_changes = nullptr);
-    Details::Edge&        GetEdge(size_t index) { return m_edges[index]; }
+    // threads_count > 1 enables parallel selection of cheapest edges, result is the same as for sequential mode
+    std::list<size_t>     BoruvkaPhase(size_t count = 1, bool* no_changes = nullptr, size_t threads_count = 1);
+    // Selection of cheapest edges runs on workers of pool and calling thread, contraction stays sequential
+    std::list<size_t>     BoruvkaPhase(size_t count, bool* no_changes, Utils::ThreadPool& pool);
+    const Details::Edge&  GetEdge(size_t index) const { return m_store->edges[m_store->index_to_slot.at(index)]; }
     std::set<size_t>      GetVertices() const;
     size_t                GetRoot(size_t v);
     std::optional<size_t> GetRootIfExists(size_t v);
 
-    const auto& GetEdges() const {return m_edges;}
-
+    // Action must not call Union: roots are resolved in batches before action is invoked
     void ForValidEdges(std::function<void(const Details::Edge&, size_t i, size_t j)> action);
+    // Same as ForValidEdges, but visits only edges incident to subset of vertex v
+    void ForValidEdgesOf(size_t v, std::function<void(const Details::Edge&, size_t i, size_t j)> action);
 private:
+    static constexpr size_t npos = Utils::DisjointSets::npos;
+
+    // Local edges and vertices are dense indexes of this graph. Vertex ids are original ids of vertices: the same
+    // as local ones for a usual graph and sorted table for subgraph views
+    size_t ToLocal(size_t v) const;
+    size_t ToId(size_t local_v) const { return m_vertex_ids.empty() ? local_v : m_vertex_ids[local_v]; }
+    size_t ToLocalEdge(size_t slot) const;
+
+    const Details::Edge& GetLocalEdge(size_t local_edge) const { return m_store->edges[m_slots[local_edge]]; }
+
     void AddToVertexToSet(size_t vertex);
+    void AddLocalEdge(size_t slot, size_t u, size_t v);
+    void UnionLocal(size_t u, size_t v);
+    bool IsValidEdge(size_t local_edge, size_t& out_u, size_t& out_v);
+
+    // Same as ForValidEdges, but with local edge and local roots
+    template<typename Action>
+    void ForValidLocalEdges(Action&& action);
+
+    // Sequential if pool is null
+    std::list<size_t> BoruvkaRounds(size_t count, bool* no_changes, Utils::ThreadPool* pool);
+    bool              ParallelCheapestEdges(std::vector<size_t>& out_cheapest, Utils::ThreadPool& pool);
+    bool ContractCheapestEdges(const std::vector<size_t>& cheapest, std::list<size_t>& result);
 
 private:
-    std::unordered_map<size_t, Details::Edge> m_edges{};
-    std::vector<std::optional<size_t>>        m_vertex_to_parent{};
-    std::unordered_map<size_t, size_t>        m_subset_to_rank{};
+    std::shared_ptr<Details::EdgeStore>   m_store{std::make_shared<Details::EdgeStore>()};
+    bool                                  m_is_view{false};
+    std::vector<size_t>                   m_slots{};       // local edge -> slot in store, ascending
+    std::vector<std::array<size_t, 2>>    m_endpoints{};   // local edge -> local vertices
+    std::vector<bool>                     m_disabled{};    // local edge -> disabled flag
+    std::vector<size_t>                   m_valid_edges{}; // local edges, lazily compacted during iteration
+    std::vector<std::vector<size_t>>      m_incidence{};   // local root -> local border edges
+    std::vector<size_t>                   m_vertex_ids{};  // local vertex -> vertex id, empty if they are the same
+    Utils::DisjointSets                   m_subsets{};     // over local vertices
+    size_t                                m_max_weight{};
+    size_t                                m_max_index{};
 };
 } // namespace Graph
@@ -22,6 +22,9 @@
 
 #pragma once
 
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
 
 namespace Graph
 {
@@ -36,6 +39,13 @@ struct Edge
     size_t j;
     size_t w;
     size_t index;
-    bool         disabled = false;
+};
+
+// Edges of the graph and of all subgraphs created from it. Edges are never changed after creation, so subgraphs
+// could read it concurrently
+struct EdgeStore
+{
+    std::vector<Edge>                  edges{};         // slot -> edge, slots are never reused
+    std::unordered_map<size_t, size_t> index_to_slot{};
 };
 } // namespace Graph::Details
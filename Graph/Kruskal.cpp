@@ -1,5 +1,9 @@
 #include "Kruskal.h"
 
+#include <Common.h>
+#include <Parallel.h>
+#include <SoftHeapCpp.h>
+
 #include <algorithm>
 #include <iostream>
 #include <list>
@@ -7,6 +11,69 @@
 /* Functions returns weight of the MST*/
 namespace Kruskal
 {
+namespace
+{
+using EdgeItr = std::vector<Edge>::iterator;
+
+// Sorting of such ranges is cheaper than one more partition
+constexpr size_t s_filter_kruskal_min_threshold = 1024;
+constexpr size_t s_pivot_sample_size        = 127;
+
+void SortAndScan(EdgeItr begin, EdgeItr end, DisjointSets& ds, std::list<size_t>& result)
+{
+    std::sort(begin, end, [](const Edge& left, const Edge& right) { return left.w < right.w; });
+    for (auto it = begin; it != end; ++it)
+    {
+        size_t set_u = ds.Find(it->u);
+        size_t set_v = ds.Find(it->v);
+        if (set_u != set_v)
+        {
+            result.push_back(it->index);
+            ds.Union(set_u, set_v);
+        }
+    }
+}
+
+// Median weight of evenly spaced sample
+size_t SelectPivot(EdgeItr begin, EdgeItr end)
+{
+    const auto size = static_cast<size_t>(std::distance(begin, end));
+    const auto step = std::max<size_t>(1, size / s_pivot_sample_size);
+
+    std::vector<size_t> sample{};
+    sample.reserve(size / step + 1);
+    for (size_t i = 0; i < size; i += step)
+        sample.push_back((begin + i)->w);
+
+    const auto k = sample.size() / 2;
+    return Utils::SoftHeapSelect<SoftHeapCpp<size_t>>(std::move(sample), k);
+}
+
+void FilterKruskal(EdgeItr begin, EdgeItr end, DisjointSets& ds, std::list<size_t>& result, size_t max_result)
+{
+    if (begin == end || result.size() >= max_result)
+        return;
+
+    // Filtering pays off only while there are noticeably more edges than vertices
+    if (static_cast<size_t>(std::distance(begin, end)) <= std::max(s_filter_kruskal_min_threshold, max_result))
+        return SortAndScan(begin, end, ds, result);
+
+    const auto pivot  = SelectPivot(begin, end);
+    auto       middle = std::partition(begin, end, [&](const Edge& edge) { return edge.w <= pivot; });
+    // Pivot is the heaviest weight: move edges of pivot weight to heavy part
+    if (middle == end)
+        middle = std::partition(begin, end, [&](const Edge& edge) { return edge.w < pivot; });
+    // All weights are the same
+    if (middle == begin)
+        return SortAndScan(begin, end, ds, result);
+
+    FilterKruskal(begin, middle, ds, result, max_result);
+
+    const auto heavy_end = std::partition(middle, end, [&](const Edge& edge) { return ds.Find(edge.u) != ds.Find(edge.v); });
+    FilterKruskal(middle, heavy_end, ds, result, max_result);
+}
+} // namespace
+
 
 
 Graph::Graph(size_t V, size_t E)
@@ -20,16 +87,16 @@ void Graph::addEdge(size_t u, size_t v, size_t w, size_t index)
     edges.push_back({w, u, v, index});
 }
 
-std::list<size_t> Graph::kruskalMST()
+std::list<size_t> Graph::kruskalMST(size_t threads_count)
 { 
     // Sort edges in increasing order on basis of cost
-    std::sort(edges.begin(), edges.end(), [](const Edge& left, const Edge& right)
+    Utils::ParallelSort(edges.begin(), edges.end(), threads_count, [](const Edge& left, const Edge& right)
     {
         return left.w < right.w;
     });
   
     // Create disjoint sets
-    DisjointSets ds(V);
+    DisjointSets ds(V + 1);
 
     std::list<size_t> result{};
   
@@ -40,8 +107,8 @@ std::list<size_t> Graph::kruskalMST()
         size_t u = it->u;
         size_t v = it->v;
   
-        size_t set_u = ds.find(u);
-        size_t set_v = ds.find(v);
+        size_t set_u = ds.Find(u);
+        size_t set_v = ds.Find(v);
   
         // Check if the selected edge is creating
         // a cycle or not (Cycle is created if u
@@ -55,53 +122,20 @@ std::list<size_t> Graph::kruskalMST()
             result.push_back(it->index);
   
             // Merge two sets
-            ds.merge(set_u, set_v);
+            ds.Union(set_u, set_v);
         }
     }
   
     return result;
 }
 
-DisjointSets::DisjointSets(size_t n)
+std::list<size_t> Graph::filterKruskalMST()
 {
-    // Allocate memory
-    this->n = n;
-    parent  = new size_t[n + 1];
-    rnk     = new size_t[n + 1];
-
-    // Initially, all vertices are in
-    // different sets and have rank 0.
-    for (size_t i = 0; i <= n; i++)
-    {
-        rnk[i] = 0;
-
-        //every element is parent of itself
-        parent[i] = i;
-    }
-}
+    DisjointSets ds(V + 1);
 
-size_t DisjointSets::find(size_t u)
-{
-    /* Make the parent of the nodes in the path
-       from u--> parent[u] point to parent[u] */
-    if (u != parent[u])
-        parent[u] = find(parent[u]);
-    return parent[u];
+    std::list<size_t> result{};
+    // Vertices are 0..V-1 (element V only pads the sets), so a spanning tree has V - 1 edges and the scan stops there
+    FilterKruskal(edges.begin(), edges.end(), ds, result, V ? V - 1 : 0);
+    return result;
 }
-
-void DisjointSets::merge(size_t x, size_t y)
-{
-    x = find(x), y = find(y);
-
-    /* Make tree with smaller height
-       a subtree of the other tree  */
-    if (rnk[x] > rnk[y])
-        parent[y] = x;
-    else // If rnk[x] <= rnk[y]
-        parent[x] = y;
-
-    if (rnk[x] == rnk[y])
-        rnk[y]++;
 }
-
-}
\ No newline at end of file
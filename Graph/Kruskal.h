@@ -2,6 +2,10 @@
 // Spanning Tree of a given connected, undirected and
 // weighted graph
 
+#pragma once
+
+#include <DisjointSets.h>
+
 #include <list>
 #include <utility>
 #include <vector>
@@ -30,24 +34,14 @@ struct Graph
     void addEdge(size_t u, size_t v, size_t w, size_t index);
 
     // Function to find MST using Kruskal's
-    // MST algorithm
-    std::list<size_t>kruskalMST();
+    // MST algorithm. Edges are sorted by threads_count threads
+    std::list<size_t>kruskalMST(size_t threads_count = 1);
+
+    // Filter-Kruskal: partitions edges around a pivot, solves light part first
+    // and drops heavy edges inside of one component before sorting them
+    std::list<size_t> filterKruskalMST();
 };
   
 // To represent Disjoint Sets
-struct DisjointSets
-{
-    size_t *parent, *rnk;
-    size_t n;
-  
-    // Constructor.
-    DisjointSets(size_t n);
-
-    // Find the parent of a node 'u'
-    // Path Compression
-    size_t find(size_t u);
-
-    // Union by rank
-    void merge(size_t x, size_t y);
-};
+using DisjointSets = Utils::DisjointSets;
 }
\ No newline at end of file
@@ -20,13 +20,20 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <CSRGraph.h>
 #include <Common.h>
+#include <Generators.h>
 #include <Graph.h>
+#include <Kruskal.h>
+#include <Parallel.h>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
 #include <array>
+#include <functional>
+#include <limits>
+#include <random>
 #include <ranges>
 
 static constexpr  bool       s_show_graphs = false;
@@ -156,4 +163,258 @@ TEST(Graph, Boruvka_2)
 
     EXPECT_EQ(0, g.GetEdgesCount());
     EXPECT_EQ(1, g.GetVerticesCount());
-}
\ No newline at end of file
+}
+TEST(Graph, ForValidEdgesOf)
+{
+    auto [g, count_of_edges, nodes_count] = FillGraph(s_adjacency_matrix);
+
+    auto collect = [&](size_t v)
+    {
+        std::set<size_t> result{};
+        g.ForValidEdgesOf(v, [&](const Graph::Details::Edge& edge, size_t, size_t) { result.emplace(edge.w); });
+        return result;
+    };
+
+    EXPECT_EQ(collect(0), (std::set<size_t>{3, 4, 11}));
+    EXPECT_EQ(collect(6), (std::set<size_t>{9, 10}));
+
+    // edge 0-3 becomes internal one, edges of 3 are visible via 0 and vice versa
+    g.Union(0, 3);
+    EXPECT_EQ(collect(0), (std::set<size_t>{4, 5, 8, 11, 12}));
+    EXPECT_EQ(collect(3), collect(0));
+
+    g.DisableEdge(g.GetEdge(0).index);
+    g.ForValidEdges([&](const Graph::Details::Edge& edge, size_t, size_t)
+    {
+        if (edge.w == 11)
+            g.DisableEdge(edge.index);
+    });
+    EXPECT_EQ(collect(0), (std::set<size_t>{5, 8, 12}));
+    EXPECT_EQ(collect(1), (std::set<size_t>{1, 2, 12}));
+}
+
+TEST(Graph, SubGraphView)
+{
+    // 0-1-2-3-4 path with chords
+    Graph::Graph g{std::vector<std::tuple<size_t, size_t, size_t>>{{0, 1, 1}, {1, 2, 2}, {2, 3, 3}, {3, 4, 4}, {0, 4, 5}, {1, 3, 6}}};
+    g.Union(0, 1);
+
+    const std::vector<size_t> indexes{5, 2, 3};
+    Graph::Graph              view{g, indexes};
+
+    // Edges are shared, endpoints are current roots of parent
+    EXPECT_EQ(&view.GetEdge(2), &g.GetEdge(2));
+    EXPECT_EQ(view.GetTotalEdgesCount(), indexes.size());
+    EXPECT_EQ(view.GetVertices(), (std::set<size_t>{g.GetRoot(1), 2, 3, 4}));
+    EXPECT_EQ(view.GetRoot(0), g.GetRoot(1));
+    EXPECT_FALSE(view.GetRootIfExists(100).has_value());
+
+    std::set<size_t> weights{};
+    view.ForValidEdgesOf(3, [&](const Graph::Details::Edge& edge, size_t, size_t) { weights.emplace(edge.w); });
+    EXPECT_EQ(weights, (std::set<size_t>{3, 4, 6}));
+
+    // Changes of view are local
+    view.Union(3, 4);
+    view.DisableEdge(5);
+    EXPECT_EQ(view.GetVerticesCount(), 3);
+    EXPECT_EQ(g.GetVerticesCount(), 4);
+    EXPECT_EQ(view.BoruvkaPhase(), (std::list<size_t>{2}));
+    EXPECT_EQ(g.GetEdgesCount(), 5);
+
+    // Views of views resolve original vertices too
+    const std::vector<size_t> nested_indexes{3};
+    Graph::Graph              nested{view, nested_indexes};
+    EXPECT_EQ(nested.GetVerticesCount(), 1);
+    EXPECT_EQ(nested.GetRoot(4), view.GetRoot(4));
+    EXPECT_THROW(nested.AddEdge(0, 1, 1), std::logic_error);
+}
+
+TEST(CSRGraph, BoruvkaAsGraph)
+{
+    const auto edges = Utils::ErdosRenie(300, 0.03);
+
+    Graph::Graph    g{edges};
+    Graph::CSRGraph csr{edges};
+
+    EXPECT_EQ(csr.GetVerticesCount(), g.GetVerticesCount());
+    EXPECT_EQ(csr.GetEdgesCount(), g.GetTotalEdgesCount());
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        auto g_result   = g.BoruvkaPhase();
+        auto csr_result = csr.BoruvkaPhase();
+        g_result.sort();
+        csr_result.sort();
+        EXPECT_EQ(g_result, csr_result);
+    }
+}
+
+TEST(CSRGraph, RejectsVertexAbove32Bits)
+{
+    const size_t vertex = size_t{std::numeric_limits<uint32_t>::max()} + 1;
+    EXPECT_THROW(Graph::CSRGraph({{0, vertex, 1}}), std::length_error);
+    EXPECT_NO_THROW(Graph::CSRGraph({{0, 1, 1}}));
+}
+
+TEST(CSRGraph, Conversions)
+{
+    const auto edges = Utils::ErdosRenie(100, 0.1);
+
+    Graph::CSRGraph csr{edges};
+    auto            full_boruvka = Graph::CSRGraph{edges}.BoruvkaPhase(100500);
+    auto            graph_result = csr.ToGraph().BoruvkaPhase(100500);
+    auto            kruskal      = csr.ToKruskal().kruskalMST();
+
+    full_boruvka.sort();
+    graph_result.sort();
+    kruskal.sort();
+    EXPECT_EQ(full_boruvka, graph_result);
+    EXPECT_EQ(full_boruvka, kruskal);
+
+    auto graph = csr.ToGraph();
+    for (size_t index = 0; index < edges.size(); ++index)
+    {
+        EXPECT_EQ(graph.GetEdge(index).w, std::get<2>(edges[index]));
+    }
+}
+
+TEST(DisjointSets, SparseElements)
+{
+    Utils::DisjointSets sets{};
+    for (size_t v : {2, 5, 7, 9})
+        sets.Add(v);
+
+    EXPECT_EQ(sets.GetSetsCount(), 4);
+    EXPECT_FALSE(sets.Contains(3));
+
+    sets.Union(2, 5);
+    sets.Union(7, 9);
+    sets.Union(5, 9);
+    sets.Add(5);
+
+    EXPECT_EQ(sets.GetSetsCount(), 1);
+    EXPECT_EQ(sets.GetSetSize(7), 4);
+
+    const std::array<size_t, 4> elements{2, 5, 7, 9};
+    std::array<size_t, 4>       roots{};
+    sets.FindBatch(elements, roots);
+    EXPECT_THAT(roots, ::testing::Each(sets.Find(2)));
+}
+
+TEST(Graph, ParallelBoruvka)
+{
+    auto edges = Utils::ErdosRenie(500, 0.02);
+    // A lot of equal weights to check deterministic tie-breaking
+    for (auto& [i, j, w] : edges)
+        w = w % 17 + 1;
+
+    Graph::Graph sequential{edges};
+    Graph::Graph parallel{edges};
+
+    for (bool no_changes = false; !no_changes;)
+    {
+        bool parallel_no_changes = false;
+        EXPECT_EQ(sequential.BoruvkaPhase(1, &no_changes), parallel.BoruvkaPhase(1, &parallel_no_changes, 4));
+        EXPECT_EQ(no_changes, parallel_no_changes);
+        EXPECT_EQ(sequential.GetVertices(), parallel.GetVertices());
+        EXPECT_EQ(sequential.GetTotalEdgesCount(), parallel.GetTotalEdgesCount());
+    }
+}
+
+TEST(Graph, ParallelBoruvkaOnPoolWithEmptyChunks)
+{
+    // 5 edges on 4 threads give chunks of 2 edges, the last chunk starts past the end
+    const std::vector<std::tuple<size_t, size_t, size_t>> edges{{0, 1, 3}, {1, 2, 1}, {2, 3, 4}, {3, 4, 2}, {4, 0, 5}};
+    Graph::Graph      sequential{edges};
+    Graph::Graph      parallel{edges};
+    Utils::ThreadPool pool{3};
+
+    EXPECT_EQ(sequential.BoruvkaPhase(100500), parallel.BoruvkaPhase(100500, nullptr, pool));
+    EXPECT_EQ(sequential.GetVertices(), parallel.GetVertices());
+}
+
+TEST(Kruskal, FilterKruskal)
+{
+    for (auto [n, degree] : std::vector<std::pair<uint32_t, double>>{{50, 4.0}, {2000, 8.0}, {20000, 3.0}})
+    {
+        const auto edges = Utils::ErdosRenie(n, degree / n);
+
+        Kruskal::Graph kruskal{n, edges.size()};
+        Kruskal::Graph filter_kruskal{n, edges.size()};
+        size_t         index = 0;
+        for (const auto& [i, j, w] : edges)
+        {
+            kruskal.addEdge(i, j, w, index);
+            filter_kruskal.addEdge(i, j, w, index++);
+        }
+
+        auto expected = kruskal.kruskalMST();
+        auto actual   = filter_kruskal.filterKruskalMST();
+        expected.sort();
+        actual.sort();
+        EXPECT_EQ(expected, actual) << n;
+    }
+}
+
+TEST(Kruskal, ParallelSort)
+{
+    std::mt19937        g{1};
+    std::vector<size_t> values(100000);
+    for (auto& value : values)
+        value = g() % 1000;
+
+    for (size_t threads : {1, 2, 3, 8})
+    {
+        auto sorted = values;
+        Utils::ParallelSort(sorted.begin(), sorted.end(), threads, std::less<>{}, 1000);
+        auto expected = values;
+        std::ranges::sort(expected);
+        EXPECT_EQ(sorted, expected) << threads;
+    }
+}
+
+TEST(Kruskal, ParallelKruskal)
+{
+    const auto edges = Utils::ErdosRenie(20000, 4.0 / 20000);
+
+    Kruskal::Graph sequential{20000, edges.size()};
+    Kruskal::Graph parallel{20000, edges.size()};
+    size_t         index = 0;
+    for (const auto& [i, j, w] : edges)
+    {
+        sequential.addEdge(i, j, w, index);
+        parallel.addEdge(i, j, w, index++);
+    }
+
+    // Unique weights: any sort order of edges gives the same tree
+    EXPECT_EQ(sequential.kruskalMST(), parallel.kruskalMST(4));
+}
+
+TEST(Kruskal, FilterKruskalEqualWeights)
+{
+    const auto edges = Utils::ErdosRenie(5000, 10.0 / 5000);
+
+    Kruskal::Graph kruskal{5000, edges.size()};
+    Kruskal::Graph filter_kruskal{5000, edges.size()};
+    std::vector<size_t> weights{};
+    size_t              index = 0;
+    for (const auto& [i, j, w] : edges)
+    {
+        weights.push_back(w % 7);
+        kruskal.addEdge(i, j, w % 7, index);
+        filter_kruskal.addEdge(i, j, w % 7, index++);
+    }
+
+    const auto total_weight = [&](const std::list<size_t>& mst)
+    {
+        size_t total = 0;
+        for (auto edge : mst)
+            total += weights[edge];
+        return total;
+    };
+
+    const auto expected = kruskal.kruskalMST();
+    const auto actual   = filter_kruskal.filterKruskalMST();
+    EXPECT_EQ(expected.size(), actual.size());
+    EXPECT_EQ(total_weight(expected), total_weight(actual));
+}
@@ -0,0 +1,117 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <Common.h>
+#include <Graph.h>
+#include <MSTSoftHeapDecorator.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+template<typename Func>
+static double MeasureSeconds(Func&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void PrintRow(const std::string& name, size_t operations, double seconds)
+{
+    std::cout << std::left << std::setw(24) << name
+              << std::right << std::setw(14) << operations
+              << std::setw(14) << std::fixed << std::setprecision(3) << seconds
+              << std::setw(18) << std::setprecision(0) << static_cast<double>(operations) / seconds << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    const size_t n   = argc > 1 ? std::stoull(argv[1]) : 200000;
+    const double eps = argc > 2 ? std::stod(argv[2]) : 1.0 / 8;
+    const size_t r   = Utils::CalculateRByEps(eps);
+
+    std::vector<size_t> weights(n);
+    std::iota(weights.begin(), weights.end(), 1);
+    std::shuffle(weights.begin(), weights.end(), std::mt19937{1});
+
+    std::vector<Graph::Details::Edge> edges{};
+    edges.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        edges.push_back(Graph::Details::Edge{0, i + 1, weights[i], i});
+
+    std::cout << "items: " << n << " r: " << r << std::endl;
+    std::cout << std::left << std::setw(24) << "scenario"
+              << std::right << std::setw(14) << "operations"
+              << std::setw(14) << "seconds"
+              << std::setw(18) << "operations/s" << std::endl;
+
+    std::set<size_t>                       bad_edges{};
+    std::pmr::unsynchronized_pool_resource memory{};
+    MST::Details::EdgeItemPool             items{};
+    MST::Details::MSTSoftHeapDecorator     heap{r, bad_edges, 0, &memory, items};
+
+    PrintRow("Insert", n, MeasureSeconds([&]
+    {
+        for (const auto& edge : edges)
+            heap.Insert(MST::Details::EdgePtrWrapper{&edge, edge.j});
+    }));
+
+    // Every second item leaves decorator but remains in the soft heap, so subsequent pops have to skip it
+    size_t deleted = 0;
+    PrintRow("DeleteAndReturnIf", n, MeasureSeconds([&]
+    {
+        deleted = heap.DeleteAndReturnIf([](const MST::Details::EdgePtrWrapper& edge) { return edge->j % 2 == 0; }).size();
+    }));
+
+    // Each outside vertex has one item here, so it is one lookup per deleted item
+    PrintRow("DeleteByOutsideVertex", n / 4, MeasureSeconds([&]
+    {
+        for (const auto& edge : edges)
+        {
+            if (edge.j % 4 == 1)
+                deleted += heap.DeleteAndReturnByOutsideVertex(edge.j).size();
+        }
+    }));
+
+    const size_t left = n - deleted;
+    PrintRow("FindMin + DeleteMin", left, MeasureSeconds([&]
+    {
+        for (size_t i = 0; i < left; ++i)
+        {
+            if (heap.FindMin())
+                heap.DeleteMin();
+        }
+    }));
+
+    if (heap.GetSize() != 0)
+        std::cout << "Decorator is not empty: " << heap.GetSize() << std::endl;
+    return 0;
+}
@@ -0,0 +1,140 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Times every engine of MST::FindMST on whole graphs of different sizes and densities to justify default thresholds
+// of MST::Options: DispatchBench [repeats]
+// Chazelle column is the soft heap path without base cases, auto column uses default options.
+
+#include <Generators.h>
+#include <Graph.h>
+#include <MST.h>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_sinks.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace
+{
+template<typename Func>
+double MeasureSeconds(Func&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct EngineColumn
+{
+    std::string name;
+    MST::Engine engine;
+    size_t      max_vertices; // engine is skipped for larger graphs
+};
+
+// Median of repeats, graph is built outside of measurement. nullopt if MST weight differs from expected one
+std::optional<double> Measure(const Utils::EdgesList& edges, MST::Engine engine, size_t repeats, size_t& weight)
+{
+    std::vector<double> seconds{};
+    for (size_t repeat = 0; repeat < repeats; ++repeat)
+    {
+        Graph::Graph      graph{edges};
+        std::list<size_t> result{};
+        seconds.push_back(MeasureSeconds([&] { result = MST::FindMST(graph, 1, MST::Options{.engine = engine}); }));
+
+        size_t result_weight = 0;
+        for (auto index : result)
+            result_weight += std::get<2>(edges[index]);
+        if (weight && weight != result_weight)
+            return std::nullopt;
+        weight = result_weight;
+    }
+    std::ranges::sort(seconds);
+    return seconds[seconds.size() / 2];
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t repeats = argc > 1 ? std::stoull(argv[1]) : 5;
+
+    spdlog::set_default_logger(spdlog::stderr_logger_mt("DispatchBench"));
+
+    const std::vector<EngineColumn> engines{{"chazelle", MST::Engine::Chazelle, std::numeric_limits<size_t>::max()},
+                                            {"boruvka", MST::Engine::Boruvka, std::numeric_limits<size_t>::max()},
+                                            {"kruskal", MST::Engine::Kruskal, std::numeric_limits<size_t>::max()},
+                                            {"prim", MST::Engine::Prim, 4096},
+                                            {"auto", MST::Engine::Auto, std::numeric_limits<size_t>::max()}};
+
+    std::cout << std::setw(8) << "vertices" << std::setw(10) << "edges" << std::setw(10) << "density";
+    for (const auto& column : engines)
+        std::cout << std::setw(12) << column.name;
+    std::cout << std::setw(12) << "best" << std::endl;
+
+    bool consistent = true;
+    for (size_t n : {16, 64, 256, 1024, 4096, 16384})
+    {
+        for (double degree : {3.0, 8.0, 32.0, static_cast<double>(n - 1)})
+        {
+            if (degree > static_cast<double>(n - 1) || (degree == static_cast<double>(n - 1) && n > 4096))
+                continue;
+
+            const auto   edges   = Utils::ErdosRenie(n, degree / static_cast<double>(n - 1));
+            const double density = static_cast<double>(edges.size()) / (static_cast<double>(n) * static_cast<double>(n - 1) / 2.0);
+
+            std::cout << std::setw(8) << n << std::setw(10) << edges.size() << std::setw(10) << std::fixed << std::setprecision(3) << density;
+
+            size_t      weight = 0;
+            std::string best{};
+            double      best_seconds = std::numeric_limits<double>::max();
+            for (const auto& column : engines)
+            {
+                if (n > column.max_vertices)
+                {
+                    std::cout << std::setw(12) << "-";
+                    continue;
+                }
+
+                const auto seconds = Measure(edges, column.engine, repeats, weight);
+                if (!seconds)
+                {
+                    consistent = false;
+                    std::cout << std::setw(12) << "mismatch";
+                    continue;
+                }
+                std::cout << std::setw(12) << std::setprecision(6) << *seconds;
+                if (column.engine != MST::Engine::Auto && *seconds < best_seconds)
+                {
+                    best_seconds = *seconds;
+                    best         = column.name;
+                }
+            }
+            std::cout << std::setw(12) << best << std::endl;
+        }
+    }
+    return consistent ? 0 : 1;
+}
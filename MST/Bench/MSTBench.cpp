@@ -0,0 +1,306 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Runs MST algorithms over generated graphs and prints JSON report:
+// MSTBench [repeats] [scale] [threads] [trace_file]
+// Graph sizes are multiplied by scale, every generator uses fixed seed. Trace file gets Chrome trace of all runs, it has
+// events only if build is configured with TRACING_ENABLE.
+// After timed repeats every algorithm is run once more under the profiler, its scopes are reported with hardware
+// counters when perf_event_open allows them. Profile is empty unless build is configured with PROFILING_ENABLE.
+
+#include <AllocTracker.h>
+#include <Common.h>
+#include <Generators.h>
+#include <Graph.h>
+#include <Kruskal.h>
+#include <MST.h>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_sinks.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+UTILS_DEFINE_ALLOCATION_TRACKING();
+
+namespace
+{
+struct GraphCase
+{
+    std::string      name;
+    Utils::EdgesList edges;
+    size_t           vertices;
+};
+
+struct Run
+{
+    double      seconds;
+    size_t      peak_bytes;
+    size_t      allocations;
+    std::string components; // JSON of peak live bytes per component
+    size_t      mst_weight;
+};
+
+// Algorithm builds its own input from edges: building is included into peak memory, but not into time
+using Algorithm = std::function<std::list<size_t>(const Utils::EdgesList& edges, size_t vertices, double& seconds)>;
+
+template<typename Func>
+double MeasureSeconds(Func&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+size_t CountVertices(const Utils::EdgesList& edges)
+{
+    size_t max_vertex = 0;
+    for (const auto& [i, j, w] : edges)
+        max_vertex = std::max({max_vertex, i, j});
+    return edges.empty() ? 0 : max_vertex + 1;
+}
+
+GraphCase MakeCase(std::string name, Utils::EdgesList edges)
+{
+    const auto vertices = CountVertices(edges);
+    return GraphCase{std::move(name), std::move(edges), vertices};
+}
+
+// Nearest-rank percentile of sorted values
+double Percentile(const std::vector<double>& sorted, double percent)
+{
+    const auto rank = static_cast<size_t>(std::ceil(percent / 100.0 * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+Run MeasureRun(const Algorithm& algorithm, const GraphCase& graph_case)
+{
+    Utils::Alloc::Reset();
+    const auto before = Utils::Alloc::GetReport().GetTotal().live_bytes;
+
+    double     seconds = 0;
+    const auto mst     = algorithm(graph_case.edges, graph_case.vertices, seconds);
+
+    size_t weight = 0;
+    for (auto index : mst)
+        weight += std::get<2>(graph_case.edges[index]);
+
+    const auto         memory = Utils::Alloc::GetReport();
+    std::ostringstream components{};
+    components << "{";
+    for (const auto& [component, name] : {std::pair{Utils::Alloc::Component::Graph, "graph"},
+                                          std::pair{Utils::Alloc::Component::MSTTree, "mst_tree"},
+                                          std::pair{Utils::Alloc::Component::SoftHeap, "soft_heap"},
+                                          std::pair{Utils::Alloc::Component::Other, "other"}})
+        components << (component == Utils::Alloc::Component::Graph ? "" : ", ") << "\"" << name << "\": " << memory.Get(component).peak_bytes;
+    components << "}";
+
+    return Run{seconds, memory.GetTotal().peak_bytes - before, memory.GetTotal().allocations, components.str(), weight};
+}
+
+// Totals of profiler scopes which were entered during the run
+std::string ProfileJson(const Utils::Profiler::Report& report)
+{
+    std::ostringstream out{};
+    out << std::setprecision(9) << "{";
+    bool first = true;
+    for (const auto* name : {"MSF", "BoruvkaPhase", "MSTTreeBuilder", "CreateSubGraphs", "Subgraphs", "BaseCase"})
+    {
+        const auto stats = report.Total(name);
+        if (stats.calls == 0)
+            continue;
+
+        out << (first ? "" : ", ") << "\"" << name << "\": {"
+            << "\"calls\": " << stats.calls << ", "
+            << "\"seconds\": " << stats.GetSeconds();
+        if (stats.has_counters)
+        {
+            out << ", \"ipc\": " << stats.GetIpc()
+                << ", \"llc_mpki\": " << stats.GetLlcMpki()
+                << ", \"branch_mpki\": " << stats.GetBranchMpki();
+        }
+        out << "}";
+        first = false;
+    }
+    out << "}";
+    return out.str();
+}
+
+Kruskal::Graph MakeKruskalGraph(const Utils::EdgesList& edges, size_t vertices)
+{
+    Kruskal::Graph graph{vertices, edges.size()};
+    size_t         index = 0;
+    for (const auto& [i, j, w] : edges)
+        graph.addEdge(i, j, w, index++);
+    return graph;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t repeats = argc > 1 ? std::stoull(argv[1]) : 5;
+    const double scale   = argc > 2 ? std::stod(argv[2]) : 1.0;
+    const size_t threads = argc > 3 ? std::stoull(argv[3]) : 1;
+    const auto   trace   = argc > 4 ? std::optional<std::string>{argv[4]} : std::nullopt;
+
+    // Keep stdout for the report only
+    spdlog::set_default_logger(spdlog::stderr_logger_mt("MSTBench"));
+
+    const auto scaled = [&](double value) { return static_cast<size_t>(std::max(1.0, value * scale)); };
+
+    std::vector<GraphCase> cases{};
+    {
+        const auto n = scaled(20000);
+        cases.push_back(MakeCase("erdos_renyi(n=" + std::to_string(n) + ",avg_degree=10)", Utils::ErdosRenie(n, 10.0 / static_cast<double>(n), 1)));
+    }
+    {
+        const auto k = static_cast<uint32_t>(std::max(1.0, std::round(std::log2(scale * 32768.0))));
+        cases.push_back(MakeCase("matrix(k=" + std::to_string(k) + ",postprocess=1)", Utils::GenerateMatrix(k, 1)));
+    }
+    {
+        const auto side = scaled(200);
+        cases.push_back(MakeCase("grid(" + std::to_string(side) + "x" + std::to_string(side) + ")", Utils::Grid(side, side, 1)));
+    }
+    {
+        const auto n = scaled(20000);
+        cases.push_back(MakeCase("power_law(n=" + std::to_string(n) + ",edges_per_vertex=4)", Utils::PowerLaw(n, 4, 1)));
+    }
+
+    const std::vector<std::pair<std::string, Algorithm>> algorithms{
+        {"chazelle",
+         [&](const Utils::EdgesList& edges, size_t, double& seconds)
+         {
+             Graph::Graph      graph{edges};
+             std::list<size_t> result{};
+             seconds = MeasureSeconds([&] { result = MST::FindMST(graph, threads, MST::Options{.engine = MST::Engine::Chazelle}); });
+             return result;
+         }},
+        {"auto",
+         [&](const Utils::EdgesList& edges, size_t, double& seconds)
+         {
+             Graph::Graph      graph{edges};
+             std::list<size_t> result{};
+             seconds = MeasureSeconds([&] { result = MST::FindMST(graph, threads); });
+             return result;
+         }},
+        {"boruvka",
+         [&](const Utils::EdgesList& edges, size_t, double& seconds)
+         {
+             Graph::Graph      graph{edges};
+             std::list<size_t> result{};
+             seconds = MeasureSeconds([&] { result = graph.BoruvkaPhase(std::numeric_limits<uint32_t>::max(), nullptr, threads); });
+             return result;
+         }},
+        {"kruskal",
+         [&](const Utils::EdgesList& edges, size_t vertices, double& seconds)
+         {
+             auto              graph = MakeKruskalGraph(edges, vertices);
+             std::list<size_t> result{};
+             seconds = MeasureSeconds([&] { result = graph.kruskalMST(); });
+             return result;
+         }},
+        {"filter_kruskal",
+         [&](const Utils::EdgesList& edges, size_t vertices, double& seconds)
+         {
+             auto              graph = MakeKruskalGraph(edges, vertices);
+             std::list<size_t> result{};
+             seconds = MeasureSeconds([&] { result = graph.filterKruskalMST(); });
+             return result;
+         }},
+    };
+
+    bool consistent = true;
+    std::cout << std::setprecision(9);
+    std::cout << "{\n  \"repeats\": " << repeats << ",\n  \"scale\": " << scale << ",\n  \"threads\": " << threads << ",\n  \"results\": [";
+    bool first = true;
+    for (const auto& graph_case : cases)
+    {
+        std::optional<size_t> reference_weight{};
+        for (const auto& [name, algorithm] : algorithms)
+        {
+            std::vector<double> seconds{};
+            size_t              peak_bytes  = 0;
+            size_t              allocations = 0;
+            std::string         components{};
+            size_t              mst_weight  = 0;
+            for (size_t i = 0; i < repeats; ++i)
+            {
+                const auto run = MeasureRun(algorithm, graph_case);
+                seconds.push_back(run.seconds);
+                peak_bytes  = std::max(peak_bytes, run.peak_bytes);
+                allocations = run.allocations;
+                components  = run.components;
+                mst_weight  = run.mst_weight;
+            }
+            std::ranges::sort(seconds);
+
+            Utils::Profiler::Reset();
+            Utils::Profiler::Enable(true);
+            MeasureRun(algorithm, graph_case);
+            Utils::Profiler::Disable();
+            const auto profile = ProfileJson(Utils::Profiler::GetReport());
+
+            if (!reference_weight)
+                reference_weight = mst_weight;
+            consistent = consistent && *reference_weight == mst_weight;
+
+            const auto median = Percentile(seconds, 50);
+            std::cout << (first ? "\n" : ",\n") << "    {"
+                      << "\"graph\": \"" << graph_case.name << "\", "
+                      << "\"vertices\": " << graph_case.vertices << ", "
+                      << "\"edges\": " << graph_case.edges.size() << ", "
+                      << "\"algorithm\": \"" << name << "\", "
+                      << "\"wall_seconds\": {"
+                      << "\"min\": " << seconds.front() << ", "
+                      << "\"median\": " << median << ", "
+                      << "\"p90\": " << Percentile(seconds, 90) << ", "
+                      << "\"max\": " << seconds.back() << "}, "
+                      << "\"edges_per_second\": " << static_cast<double>(graph_case.edges.size()) / median << ", "
+                      << "\"peak_heap_bytes\": " << peak_bytes << ", "
+                      << "\"allocations\": " << allocations << ", "
+                      << "\"peak_bytes_by_component\": " << components << ", "
+                      << "\"mst_weight\": " << mst_weight << ", "
+                      << "\"profile\": " << profile << "}";
+            first = false;
+        }
+    }
+    if (trace)
+    {
+        std::ofstream trace_file{*trace};
+        Utils::WriteChromeTrace(trace_file);
+    }
+
+    std::cout << "\n  ],\n  \"consistent\": " << (consistent ? "true" : "false") << "\n}" << std::endl;
+    return consistent ? 0 : 1;
+}
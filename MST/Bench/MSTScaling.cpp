@@ -0,0 +1,186 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Sweeps thread counts over graphs of different sizes and densities and prints CSV to plot scalability:
+// MSTScaling [max_threads] [repeats] [scale]
+// Thread counts are powers of two up to max_threads (hardware threads by default) and max_threads itself. Speedup and
+// efficiency are relative to the single thread run of the same engine and graph. Idle time per thread is wall time
+// minus process CPU time spread over threads, waiting which spins or yields is counted as busy.
+
+#include <Generators.h>
+#include <Graph.h>
+#include <Kruskal.h>
+#include <MST.h>
+#include <Parallel.h>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_sinks.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct GraphCase
+{
+    std::string      name;
+    Utils::EdgesList edges;
+    size_t           vertices;
+};
+
+struct Sample
+{
+    double wall_seconds;
+    double cpu_seconds;
+};
+
+// Runs engine with given threads count, input is built before the call and is not measured
+using Engine = std::function<Sample(const GraphCase& graph_case, size_t threads)>;
+
+template<typename Func>
+Sample MeasureSample(Func&& func)
+{
+    const auto wall_start = std::chrono::steady_clock::now();
+    const auto cpu_start  = std::clock();
+    func();
+    const auto cpu_end = std::clock();
+    return Sample{std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count(),
+                  static_cast<double>(cpu_end - cpu_start) / CLOCKS_PER_SEC};
+}
+
+size_t CountVertices(const Utils::EdgesList& edges)
+{
+    size_t max_vertex = 0;
+    for (const auto& [i, j, w] : edges)
+        max_vertex = std::max({max_vertex, i, j});
+    return edges.empty() ? 0 : max_vertex + 1;
+}
+
+GraphCase MakeCase(std::string name, Utils::EdgesList edges)
+{
+    const auto vertices = CountVertices(edges);
+    return GraphCase{std::move(name), std::move(edges), vertices};
+}
+
+// Sample with median wall time
+Sample MedianSample(std::vector<Sample> samples)
+{
+    std::ranges::sort(samples, {}, &Sample::wall_seconds);
+    return samples[samples.size() / 2];
+}
+
+std::vector<size_t> ThreadCounts(size_t max_threads)
+{
+    std::vector<size_t> result{};
+    for (size_t threads = 1; threads < max_threads; threads *= 2)
+        result.push_back(threads);
+    result.push_back(max_threads);
+    return result;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t max_threads = std::max<size_t>(1, argc > 1 ? std::stoull(argv[1]) : Utils::GetHardwareThreadsCount());
+    const size_t repeats     = std::max<size_t>(1, argc > 2 ? std::stoull(argv[2]) : 3);
+    const double scale       = argc > 3 ? std::stod(argv[3]) : 1.0;
+
+    // Keep stdout for CSV only
+    spdlog::set_default_logger(spdlog::stderr_logger_mt("MSTScaling"));
+
+    const auto scaled = [&](double value) { return static_cast<size_t>(std::max(1.0, value * scale)); };
+
+    std::vector<GraphCase> cases{};
+    for (const auto n : {scaled(50000), scaled(200000)})
+    {
+        for (const auto degree : {4.0, 32.0})
+        {
+            cases.push_back(MakeCase("erdos_renyi(n=" + std::to_string(n) + ",avg_degree=" + std::to_string(static_cast<size_t>(degree)) + ")",
+                                     Utils::ErdosRenie(n, degree / static_cast<double>(n), 1)));
+        }
+    }
+    for (const auto k : {14u, 17u})
+    {
+        const auto scaled_k = static_cast<uint32_t>(std::max(1.0, std::round(k + std::log2(scale))));
+        cases.push_back(MakeCase("matrix(k=" + std::to_string(scaled_k) + ",postprocess=1)", Utils::GenerateMatrix(scaled_k, 1)));
+    }
+
+    const std::vector<std::pair<std::string, Engine>> engines{
+        {"find_mst",
+         [](const GraphCase& graph_case, size_t threads)
+         {
+             Graph::Graph graph{graph_case.edges};
+             return MeasureSample([&] { MST::FindMST(graph, threads, MST::Options{.engine = MST::Engine::Chazelle}); });
+         }},
+        {"boruvka_phase",
+         [](const GraphCase& graph_case, size_t threads)
+         {
+             Graph::Graph graph{graph_case.edges};
+             return MeasureSample([&] { graph.BoruvkaPhase(std::numeric_limits<uint32_t>::max(), nullptr, threads); });
+         }},
+        {"kruskal",
+         [](const GraphCase& graph_case, size_t threads)
+         {
+             Kruskal::Graph graph{graph_case.vertices, graph_case.edges.size()};
+             size_t         index = 0;
+             for (const auto& [i, j, w] : graph_case.edges)
+                 graph.addEdge(i, j, w, index++);
+             return MeasureSample([&] { graph.kruskalMST(threads); });
+         }},
+    };
+
+    std::cout << std::setprecision(6);
+    std::cout << "engine,graph,vertices,edges,threads,wall_seconds,cpu_seconds,speedup,efficiency,idle_seconds_per_thread\n";
+    for (const auto& graph_case : cases)
+    {
+        for (const auto& [name, engine] : engines)
+        {
+            double single_thread_seconds = 0;
+            for (const auto threads : ThreadCounts(max_threads))
+            {
+                std::vector<Sample> samples{};
+                for (size_t i = 0; i < repeats; ++i)
+                    samples.push_back(engine(graph_case, threads));
+                const auto sample = MedianSample(std::move(samples));
+
+                if (threads == 1)
+                    single_thread_seconds = sample.wall_seconds;
+                const auto speedup = single_thread_seconds / sample.wall_seconds;
+                const auto idle    = std::max(0.0, sample.wall_seconds - sample.cpu_seconds / static_cast<double>(threads));
+
+                // Graph names contain commas, so they are quoted
+                std::cout << name << ",\"" << graph_case.name << "\"," << graph_case.vertices << "," << graph_case.edges.size() << ","
+                          << threads << "," << sample.wall_seconds << "," << sample.cpu_seconds << "," << speedup << ","
+                          << speedup / static_cast<double>(threads) << "," << idle << std::endl;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,196 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Picks parameters of MST::Options for each class of generated graphs and prints them as JSON:
+// MSTTune [repeats] [scale] [passes]
+// Full grid is too large, so parameters are tuned one by one, each pass sweeps all of them keeping the best values of
+// others. Every configuration is checked against MST weight of Boruvka.
+
+#include <Generators.h>
+#include <Graph.h>
+#include <MST.h>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_sinks.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct GraphClass
+{
+    std::string      name;
+    Utils::EdgesList edges;
+};
+
+// Setter of one parameter and values to sweep
+struct Parameter
+{
+    std::string                                 name;
+    std::vector<double>                         values;
+    std::function<void(MST::Options&, double)>  set;
+    std::function<double(const MST::Options&)> get;
+};
+
+template<typename Func>
+double MeasureSeconds(Func&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+size_t Weight(const Utils::EdgesList& edges, const std::list<size_t>& mst)
+{
+    size_t weight = 0;
+    for (auto index : mst)
+        weight += std::get<2>(edges[index]);
+    return weight;
+}
+
+// Median of repeats, nullopt if any run returns wrong MST
+std::optional<double> Measure(const Utils::EdgesList& edges, const MST::Options& options, size_t repeats, size_t expected_weight)
+{
+    std::vector<double> seconds{};
+    for (size_t repeat = 0; repeat < repeats; ++repeat)
+    {
+        Graph::Graph      graph{edges};
+        std::list<size_t> result{};
+        seconds.push_back(MeasureSeconds([&] { result = MST::FindMST(graph, 1, options); }));
+        if (Weight(edges, result) != expected_weight)
+            return std::nullopt;
+    }
+    std::ranges::sort(seconds);
+    return seconds[seconds.size() / 2];
+}
+
+template<typename Field>
+Parameter MakeParameter(std::string name, std::vector<double> values, Field MST::Options::*field)
+{
+    return Parameter{std::move(name),
+                     std::move(values),
+                     [field](MST::Options& options, double value) { options.*field = static_cast<Field>(value); },
+                     [field](const MST::Options& options) { return static_cast<double>(options.*field); }};
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t repeats = argc > 1 ? std::stoull(argv[1]) : 3;
+    const double scale   = argc > 2 ? std::stod(argv[2]) : 1.0;
+    const size_t passes  = argc > 3 ? std::stoull(argv[3]) : 2;
+
+    // Keep stdout for the report only
+    spdlog::set_default_logger(spdlog::stderr_logger_mt("MSTTune"));
+
+    const auto scaled = [&](double value) { return static_cast<size_t>(std::max(2.0, value * scale)); };
+
+    std::vector<GraphClass> classes{};
+    {
+        const auto n = scaled(20000);
+        classes.push_back({"sparse_random", Utils::ErdosRenie(n, 10.0 / static_cast<double>(n), 1)});
+    }
+    {
+        const auto n = scaled(2000);
+        classes.push_back({"dense_random", Utils::ErdosRenie(n, 0.1, 1)});
+    }
+    classes.push_back({"matrix", Utils::GenerateMatrix(static_cast<uint32_t>(std::max(1.0, std::round(std::log2(scale * 32768.0)))), 1)});
+    {
+        const auto side = scaled(200);
+        classes.push_back({"grid", Utils::Grid(side, side, 1)});
+    }
+    classes.push_back({"power_law", Utils::PowerLaw(scaled(20000), 4, 1)});
+
+    const std::vector<Parameter> parameters{
+        MakeParameter("c", {2, 3, 4, 6, 8}, &MST::Options::c),
+        MakeParameter("eps", {0, 0.5, 0.25, 0.125, 0.0625}, &MST::Options::eps),
+        MakeParameter("t", {0, 1, 2, 3}, &MST::Options::t),
+        MakeParameter("boruvka_rounds", {0, 1, 2, 4, 8}, &MST::Options::boruvka_rounds),
+        MakeParameter("boruvka_max_edges", {0, 4096, 16384, 65536, 262144}, &MST::Options::boruvka_max_edges),
+    };
+
+    bool consistent = true;
+    std::cout << std::setprecision(9) << "{\n  \"repeats\": " << repeats << ",\n  \"scale\": " << scale << ",\n  \"results\": [";
+    for (size_t class_index = 0; class_index < classes.size(); ++class_index)
+    {
+        const auto& [name, edges] = classes[class_index];
+
+        Graph::Graph reference{edges};
+        const auto   expected_weight = Weight(edges, reference.BoruvkaPhase(std::numeric_limits<uint32_t>::max()));
+
+        const MST::Options defaults{};
+        const auto         default_seconds = Measure(edges, defaults, repeats, expected_weight);
+        if (!default_seconds)
+            consistent = false;
+
+        MST::Options best         = defaults;
+        double       best_seconds = default_seconds.value_or(std::numeric_limits<double>::max());
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (const auto& parameter : parameters)
+            {
+                for (auto value : parameter.values)
+                {
+                    if (parameter.get(best) == value)
+                        continue;
+
+                    auto options = best;
+                    parameter.set(options, value);
+                    const auto seconds = Measure(edges, options, repeats, expected_weight);
+                    if (!seconds)
+                    {
+                        consistent = false;
+                        spdlog::error("{}: wrong MST with {} = {}", name, parameter.name, value);
+                        continue;
+                    }
+                    if (*seconds < best_seconds)
+                    {
+                        best_seconds = *seconds;
+                        best         = options;
+                    }
+                }
+            }
+        }
+
+        std::cout << (class_index ? ",\n" : "\n") << "    {"
+                  << "\"graph\": \"" << name << "\", "
+                  << "\"edges\": " << edges.size() << ", "
+                  << "\"default_seconds\": " << default_seconds.value_or(-1) << ", "
+                  << "\"best_seconds\": " << best_seconds << ", "
+                  << "\"options\": {";
+        for (size_t index = 0; index < parameters.size(); ++index)
+            std::cout << (index ? ", " : "") << "\"" << parameters[index].name << "\": " << parameters[index].get(best);
+        std::cout << "}}";
+    }
+    std::cout << "\n  ],\n  \"consistent\": " << (consistent ? "true" : "false") << "\n}" << std::endl;
+    return consistent ? 0 : 1;
+}
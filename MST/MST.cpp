@@ -24,33 +24,163 @@
 
 #include "MST.h"
 
+#include "MSTEngines.h"
 #include "MSTTreeBuilder.h"
 #include "MSTUtils.h"
 
+#include <AllocTracker.h>
 #include <Common.h>
 #include <Graph.h>
+#include <ThreadPool.h>
 #include <spdlog/spdlog.h>
 
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
 
 
 namespace MST
 {
-std::list<size_t> MSF(Graph::Graph& graph, size_t max_height, size_t recursion_level = 1, size_t t = 0)
+namespace
 {
+// Adds elapsed seconds to target on destruction, does nothing without target
+class PhaseTimer
+{
+public:
+    explicit PhaseTimer(double* target)
+        : m_target{target}
+    {
+        if (m_target)
+            m_start = std::chrono::steady_clock::now();
+    }
+
+    ~PhaseTimer()
+    {
+        if (m_target)
+            *m_target += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    double*                               m_target;
+    std::chrono::steady_clock::time_point m_start{};
+};
+
+// Combines values with the same index, missed ones are zeros
+template<typename Op>
+void MergeValues(std::vector<size_t>& to, const std::vector<size_t>& from, Op&& op)
+{
+    if (to.size() < from.size())
+        to.resize(from.size());
+    for (size_t i = 0; i < from.size(); ++i)
+        to[i] = op(to[i], from[i]);
+}
+
+void MergeStats(Stats& to, const Stats& from)
+{
+    to.recursion_depth = std::max(to.recursion_depth, from.recursion_depth);
+    to.tree_builds += from.tree_builds;
+    to.extensions += from.extensions;
+    to.retractions += from.retractions;
+    to.fusions += from.fusions;
+    to.bad_edges += from.bad_edges;
+    to.heap_inserts += from.heap_inserts;
+    to.heap_deletes += from.heap_deletes;
+    to.heap_ckey_raises += from.heap_ckey_raises;
+    to.heap_corrupted += from.heap_corrupted;
+    to.heap_max_list_size = std::max(to.heap_max_list_size, from.heap_max_list_size);
+    to.boruvka_seconds += from.boruvka_seconds;
+    to.trees_seconds += from.trees_seconds;
+    to.base_case_seconds += from.base_case_seconds;
+
+    MergeValues(to.boruvka_contractions, from.boruvka_contractions, std::plus<>{});
+    MergeValues(to.heap_raises_per_rank, from.heap_raises_per_rank, std::plus<>{});
+    MergeValues(to.r_per_level, from.r_per_level, [](size_t lhs, size_t rhs) { return std::max(lhs, rhs); });
+}
+
+// Keeps share of corrupted items between eps / 4 and eps. More corruption than the soft heap bound only grows bad
+// edges of the next recursion, less of it means that precision of heaps is paid for without use
+size_t AdaptR(size_t r, double eps, size_t inserts, size_t corrupted)
+{
+    static constexpr size_t max_r = 64;
+    if (!inserts)
+        return r;
+
+    const double rate = static_cast<double>(corrupted) / static_cast<double>(inserts);
+    if (rate > eps && r < max_r)
+        return r + 1;
+    if (rate < eps / 4 && r > 1)
+        return r - 1;
+    return r;
+}
+
+std::list<size_t> BaseCase(Graph::Graph& graph, Engine engine, Stats* stats)
+{
+    UTILS_PROFILE_SCOPE("BaseCase");
+    Utils::Alloc::ComponentScope memory{Utils::Alloc::Component::Graph};
+    PhaseTimer timer{stats ? &stats->base_case_seconds : nullptr};
+    switch (engine)
+    {
+        case Engine::Boruvka: return BoruvkaMSF(graph);
+        case Engine::Kruskal: return KruskalMSF(graph);
+        default: return PrimMSF(graph);
+    }
+}
+} // namespace
+
+// Zero t and r are derived from graph and options, subgraphs get them from their parent
+std::list<size_t> MSF(Graph::Graph&      graph,
+                      const Options&     options,
+                      size_t             max_height,
+                      size_t             recursion_level = 1,
+                      size_t             t               = 0,
+                      size_t             r               = 0,
+                      Utils::ThreadPool* pool            = nullptr,
+                      Stats*             stats           = nullptr)
+{
+    UTILS_PROFILE_SCOPE("MSF");
+    Utils::Alloc::LevelScope memory_level{recursion_level};
     SPDLOG_DEBUG("max_height {}", max_height);
+    if (stats)
+        stats->recursion_depth = std::max(stats->recursion_depth, recursion_level);
+
+    if (const auto engine = ChooseEngine(graph, options); engine != Engine::Chazelle)
+        return BaseCase(graph, engine, stats);
+
     if (!t)
-        t = FindParamT(graph, max_height <= 2 ? 3 : max_height);
-    size_t count = t <= 1 ? std::numeric_limits<uint32_t>::max() : c;
+        t = options.t ? options.t : FindParamT(graph, max_height <= 2 ? 3 : max_height);
+    const size_t rounds = options.boruvka_rounds ? options.boruvka_rounds : options.c;
+    size_t       count  = t <= 1 ? std::numeric_limits<uint32_t>::max() : rounds;
+    const double eps    = options.eps > 0 ? options.eps : 1 / static_cast<double>(options.c);
+    if (!r)
+        r = Utils::CalculateRByEps(eps);
 
-    if (recursion_level == 1)
-        std::cout << " t is  " << t << std::endl;
+    if (stats && recursion_level == 1)
+        stats->t = t;
 
     SPDLOG_DEBUG("t is {} Recursion {}", t, recursion_level);
 
     bool no_changes = false;
-    std::list<size_t> boruvka_result = graph.BoruvkaPhase(count, &no_changes);
+    std::list<size_t> boruvka_result{};
+    {
+        PhaseTimer                   timer{stats ? &stats->boruvka_seconds : nullptr};
+        Utils::Alloc::ComponentScope memory{Utils::Alloc::Component::Graph};
+        // Recursive calls are already parallel, so only the top level runs parallel Boruvka on workers of the pool
+        boruvka_result = pool && recursion_level == 1 ? graph.BoruvkaPhase(count, &no_changes, *pool)
+                                                      : graph.BoruvkaPhase(count, &no_changes);
+    }
+    if (stats)
+    {
+        if (stats->boruvka_contractions.size() < recursion_level)
+            stats->boruvka_contractions.resize(recursion_level);
+        stats->boruvka_contractions[recursion_level - 1] += boruvka_result.size();
+    }
     if (no_changes)
         return boruvka_result;
 
@@ -58,47 +188,158 @@ std::list<size_t> MSF(Graph::Graph& graph, size_t max_height, size_t recursion_l
     std::set<size_t> vertices = graph.GetVertices();
     std::list<size_t> bad_edges ={};
     std::list<Graph::Graph> graphs{};
-    while (!vertices.empty())
+    SoftHeapCounters        heap_counters{};
+    SoftHeapObserver*       heap_observer = stats || options.adaptive_r ? &heap_counters : nullptr;
+    size_t                  max_used_r{};
     {
-        auto  tree_builder = MSTTreeBuilder(graph, t, max_height, *vertices.begin());
-        auto& tree         = tree_builder.GetTree();
+        PhaseTimer timer{stats ? &stats->trees_seconds : nullptr};
+        while (!vertices.empty())
+        {
+            const auto inserts_before   = heap_counters.inserts;
+            const auto corrupted_before = heap_counters.corrupted;
+
+            max_used_r = std::max(max_used_r, r);
+            Utils::Alloc::ComponentScope tree_memory{Utils::Alloc::Component::MSTTree};
+            auto  tree_builder = MSTTreeBuilder(graph, t, max_height, r, *vertices.begin(), heap_observer);
+            auto& tree         = tree_builder.GetTree();
+
+            for (const auto& vert : tree.GetVerticesInside())
+                vertices.erase(vert);
+
+            auto cur_bad_edges = tree.GetBadEdges();
+            if (stats)
+            {
+                const auto& counters = tree_builder.GetCounters();
+                ++stats->tree_builds;
+                stats->extensions += counters.extensions;
+                stats->retractions += counters.retractions;
+                stats->fusions += counters.fusions;
+                stats->bad_edges += cur_bad_edges.size();
+                stats->heap_inserts += tree.GetHeapItems().GetSize();
+                stats->heap_deletes += tree.GetHeapItems().GetDeletesCount();
+            }
+
+            {
+                Utils::Alloc::ComponentScope graph_memory{Utils::Alloc::Component::Graph};
+                graphs.splice(graphs.end(), tree.CreateSubGraphs(cur_bad_edges));
+            }
+            std::ranges::move(cur_bad_edges, std::inserter(bad_edges, bad_edges.end()));
 
-        for (const auto& vert : tree.GetVerticesInside())
-            vertices.erase(vert);
+            if (options.adaptive_r)
+                r = AdaptR(r, eps, heap_counters.inserts - inserts_before, heap_counters.corrupted - corrupted_before);
+        }
+    }
+
+    if (stats)
+    {
+        stats->heap_ckey_raises += heap_counters.ckey_raises;
+        stats->heap_corrupted += heap_counters.corrupted;
+        stats->heap_max_list_size = std::max(stats->heap_max_list_size, heap_counters.max_list_size);
+        MergeValues(stats->heap_raises_per_rank, heap_counters.raises_per_rank, std::plus<>{});
 
-        auto cur_bad_edges = tree.GetBadEdges();
-        graphs.splice(graphs.end(), tree.CreateSubGraphs(cur_bad_edges));
-        std::ranges::move(cur_bad_edges, std::inserter(bad_edges, bad_edges.end()));
+        if (stats->r_per_level.size() < recursion_level)
+            stats->r_per_level.resize(recursion_level);
+        stats->r_per_level[recursion_level - 1] = std::max(stats->r_per_level[recursion_level - 1], max_used_r);
     }
 
-    //SPDLOG_INFO("BAD EDGES COUNT {}", bad_edges.size());
+    // Subgraphs are independent, results and stats are merged in the same order as for sequential run
+    std::vector<std::list<size_t>> subgraphs_results(graphs.size());
+    std::vector<Stats>             subgraphs_stats(stats ? graphs.size() : 0);
+    auto solve_subgraph = [&](Graph::Graph& subgraph, size_t index)
+    {
+        subgraphs_results[index] = MSF(subgraph, options, max_height, recursion_level + 1, t > 1 ? t-1 : t, r, pool,
+                                       stats ? &subgraphs_stats[index] : nullptr);
+    };
+
+    {
+        UTILS_PROFILE_SCOPE("Subgraphs");
+        if (pool && graphs.size() > 1)
+        {
+            Utils::TaskGroup group{*pool};
+            size_t           index = 0;
+            for (auto& subgraph : graphs)
+                group.Run([&, &subgraph = subgraph, index = index++] { solve_subgraph(subgraph, index); });
+            group.Wait();
+        }
+        else
+        {
+            size_t index = 0;
+            for (auto& subgraph : graphs)
+                solve_subgraph(subgraph, index++);
+        }
+    }
 
-    //for(auto& edge : bad_edges)
-    //    SPDLOG_DEBUG("{}", edge);
+    for (const auto& subgraph_stats : subgraphs_stats)
+        MergeStats(*stats, subgraph_stats);
 
     std::list<size_t> F = bad_edges;
-    for (auto& subgraph : graphs)
-        F.splice(F.end(), MSF(subgraph, max_height, recursion_level + 1, t > 1 ? t-1 : t));
+    for (auto& result : subgraphs_results)
+        F.splice(F.end(), result);
 
 
-    Graph::Graph new_graph{};
-    for (const auto& edge : F)
+    const std::vector<size_t> F_edges{F.cbegin(), F.cend()};
+    Graph::Graph              new_graph = [&]
     {
-        auto& orig_edge = graph.GetEdge(edge);
-        auto i = graph.GetRoot(orig_edge.i);
-        auto j = graph.GetRoot(orig_edge.j);
-        new_graph.AddEdge(i, j, orig_edge.w, edge);
-    }
+        Utils::Alloc::ComponentScope memory{Utils::Alloc::Component::Graph};
+        return Graph::Graph{graph, F_edges};
+    }();
 
-    boruvka_result.splice(boruvka_result.end(), MSF(new_graph, max_height, recursion_level+1, t));
+    boruvka_result.splice(boruvka_result.end(), MSF(new_graph, options, max_height, recursion_level+1, t, r, pool, stats));
     return boruvka_result;
 }
 
-std::list<size_t> FindMST(Graph::Graph& graph)
+static std::list<size_t> Solve(Graph::Graph& graph, size_t threads_count, const Options& options, Stats* stats)
 {
-    spdlog::set_level(spdlog::level::debug);
-    spdlog::set_pattern("Line: %4# [%-35!] %v");
+    if (threads_count <= 1)
+        return MSF(graph, options, FindMaxHeight(graph, options.c), 1, 0, 0, nullptr, stats);
+
+    // Calling thread takes part in the work while it waits for results
+    Utils::ThreadPool pool{threads_count - 1};
+    return MSF(graph, options, FindMaxHeight(graph, options.c), 1, 0, 0, &pool, stats);
+}
+
+std::list<size_t> FindMST(Graph::Graph& graph, size_t threads_count, const Options& options, Stats* stats)
+{
+    // Global logger state is configured once, concurrent calls only log
+    static std::once_flag s_logger_configured{};
+    std::call_once(s_logger_configured, []
+    {
+        spdlog::set_level(spdlog::level::debug);
+        spdlog::set_pattern("Line: %4# [%-35!] %v");
+    });
+
+    // With c = 1 trees are too low for their subgraphs to contain all MST edges, results miss edges
+    if (options.c < 2 || options.eps < 0 || options.eps >= 1)
+        throw std::invalid_argument{"MST options: c must be at least 2 and eps must be in [0, 1)"};
+
+    if (stats)
+        *stats = Stats{};
+    PhaseTimer timer{stats ? &stats->total_seconds : nullptr};
+
+    // Heaps pack working costs and edge indexes into 32 bits each. MST depends only on order of weights, so larger
+    // ones are replaced by ranks, and ranks serve as dense indexes which are mapped back in the result
+    constexpr size_t max_packed = std::numeric_limits<uint32_t>::max();
+    if (graph.GetMaxWeight() > max_packed || graph.GetMaxIndex() > max_packed)
+    {
+        std::vector<std::tuple<size_t, size_t, const Graph::Details::Edge*>> edges{};
+        graph.ForValidEdges([&](const Graph::Details::Edge& edge, size_t i, size_t j) { edges.emplace_back(i, j, &edge); });
+        std::ranges::sort(edges, std::less<>{}, [](const auto& edge) { return std::pair{std::get<2>(edge)->w, std::get<2>(edge)->index}; });
+        if (edges.size() > max_packed)
+            throw std::invalid_argument{"MST: number of edges must fit into 32 bits"};
+
+        Graph::Graph ranked{};
+        for (size_t rank = 0; rank < edges.size(); ++rank)
+        {
+            const auto& [i, j, edge] = edges[rank];
+            ranked.AddEdge(i, j, rank + 1, rank);
+        }
+
+        auto result = Solve(ranked, threads_count, options, stats);
+        for (auto& index : result)
+            index = std::get<2>(edges[index])->index;
+        return result;
+    }
 
-    return MSF(graph, FindMaxHeight(graph, c));
+    return Solve(graph, threads_count, options, stats);
 }
 } // namespace MST
@@ -24,8 +24,69 @@
 
 #include "Graph.h"
 
+#include <list>
+#include <vector>
+
 namespace MST
 {
-static constexpr uint32_t c = 4;
-std::list<size_t>       FindMST(Graph::Graph& graph);
+enum class Engine
+{
+    Auto,     // chosen per call of recursion by thresholds below
+    Chazelle, // soft heap based recursion
+    Boruvka,  // Boruvka phases until graph is contracted
+    Kruskal,
+    Prim,     // O(n^2 + m) with linear scan for the next vertex, for dense graphs
+};
+
+struct Options
+{
+    Engine engine = Engine::Auto;
+
+    // Soft heap recursion, zero means value derived from graph or from other parameters. MSTTune picks them per class
+    // of graphs
+    uint32_t c              = 4; // max height of trees is c * (m / n)^(1/3), at least 2
+    double   eps            = 0; // error rate of soft heaps, 1 / c by default
+    size_t   t              = 0; // FindParamT by default
+    size_t   boruvka_rounds = 0; // Boruvka phases before building of trees, c by default
+    // Each call of recursion tunes r after every tree by corruption rate of its heaps and passes it to the next level
+    bool     adaptive_r     = false;
+
+    // Thresholds of Engine::Auto are picked by DispatchBench: soft heap machinery costs more than it saves on small
+    // subgraphs, Boruvka phases are the fastest there. Kruskal only ties with them on almost forests, so it is off.
+    // Prim (O(n^2 + m), n^2 of it is the linear search of the next vertex) loses to Boruvka about 2x on complete graphs
+    // of 1024..4096 vertices, so its window is empty by default
+    size_t boruvka_max_edges  = 65536;
+    double kruskal_max_degree = 0;    // edges / vertices
+    size_t prim_min_vertices  = 2048;
+    size_t prim_max_vertices  = 0;
+    double prim_min_density   = 0.5;  // edges / (n * (n - 1) / 2)
+};
+
+// Filled by FindMST on request. Counters are summed over all calls of recursion, seconds are summed over all threads
+struct Stats
+{
+    size_t              t{};                    // of the top level call
+    size_t              recursion_depth{};
+    size_t              tree_builds{};
+    size_t              extensions{};
+    size_t              retractions{};
+    size_t              fusions{};
+    size_t              bad_edges{};            // corrupted edges left out of subgraphs of trees
+    size_t              heap_inserts{};
+    size_t              heap_deletes{};
+    size_t              heap_ckey_raises{};     // concatenations of item lists by sift
+    size_t              heap_corrupted{};       // items corrupted by raise of ckey, each counted once
+    size_t              heap_max_list_size{};
+    std::vector<size_t> heap_raises_per_rank{};
+    std::vector<size_t> r_per_level{};          // the largest r of trees on each recursion level, zero if none
+    std::vector<size_t> boruvka_contractions{}; // per recursion level, starting from the top one
+    double              boruvka_seconds{};
+    double              trees_seconds{};        // building of trees and their subgraphs
+    double              base_case_seconds{};    // engines chosen instead of recursion
+    double              total_seconds{};
+};
+
+// threads_count > 1 solves independent subgraphs of recursion in parallel. Throws std::invalid_argument if c is less
+// than 2 or eps is not in [0, 1). Nothing is measured if stats is null
+std::list<size_t>       FindMST(Graph::Graph& graph, size_t threads_count = 1, const Options& options = {}, Stats* stats = nullptr);
 }
@@ -0,0 +1,147 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MSTEngines.h"
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <tuple>
+#include <vector>
+
+namespace MST
+{
+Engine ChooseEngine(Graph::Graph& graph, const Options& options)
+{
+    if (options.engine != Engine::Auto)
+        return options.engine;
+
+    // Edges which became loops after contractions are dropped lazily, so only a pass over valid edges counts them
+    size_t valid_edges = 0;
+    graph.ForValidEdges([&](const Graph::Details::Edge&, size_t, size_t) { ++valid_edges; });
+
+    const auto vertices = static_cast<double>(graph.GetVerticesCount());
+    const auto edges    = static_cast<double>(valid_edges);
+
+    const double max_edges = vertices * (vertices - 1) / 2.0;
+    if (vertices >= static_cast<double>(options.prim_min_vertices) &&
+        vertices <= static_cast<double>(options.prim_max_vertices) &&
+        edges >= options.prim_min_density * max_edges)
+        return Engine::Prim;
+
+    if (edges <= options.kruskal_max_degree * vertices)
+        return Engine::Kruskal;
+
+    if (edges <= static_cast<double>(options.boruvka_max_edges))
+        return Engine::Boruvka;
+
+    return Engine::Chazelle;
+}
+
+std::list<size_t> BoruvkaMSF(Graph::Graph& graph)
+{
+    return graph.BoruvkaPhase(std::numeric_limits<size_t>::max());
+}
+
+std::list<size_t> KruskalMSF(Graph::Graph& graph)
+{
+    std::vector<const Graph::Details::Edge*> edges{};
+    edges.reserve(graph.GetTotalEdgesCount());
+    graph.ForValidEdges([&](const Graph::Details::Edge& edge, size_t, size_t) { edges.push_back(&edge); });
+
+    // Ties are broken by index, the same as heaps of Chazelle path do
+    std::ranges::sort(edges, [](const Graph::Details::Edge* left, const Graph::Details::Edge* right)
+    {
+        return std::tie(left->w, left->index) < std::tie(right->w, right->index);
+    });
+
+    // Union-find of the graph itself is used, so roots of original vertices are resolved as usual
+    std::list<size_t> result{};
+    for (const auto* edge : edges)
+    {
+        const auto i = graph.GetRoot(edge->i);
+        const auto j = graph.GetRoot(edge->j);
+        if (i == j)
+            continue;
+
+        graph.Union(i, j);
+        result.push_back(edge->index);
+    }
+    return result;
+}
+
+std::list<size_t> PrimMSF(Graph::Graph& graph)
+{
+    const auto                roots = graph.GetVertices();
+    const std::vector<size_t> vertices{roots.cbegin(), roots.cend()};
+    const size_t              n = vertices.size();
+    auto to_local = [&](size_t v) { return static_cast<size_t>(std::ranges::lower_bound(vertices, v) - vertices.cbegin()); };
+
+    auto is_cheaper = [](const Graph::Details::Edge* edge, const Graph::Details::Edge* than)
+    {
+        return !than || std::tie(edge->w, edge->index) < std::tie(than->w, than->index);
+    };
+
+    // Edges of a vertex are scanned once when it joins the tree, next vertex is found by a linear scan: O(n^2 + m) time
+    // and O(n) memory
+    std::vector<const Graph::Details::Edge*> cheapest(n, nullptr);
+    std::vector<bool>                        in_tree(n, false);
+    std::vector<const Graph::Details::Edge*> chosen{};
+    for (size_t start = 0; start < n; ++start)
+    {
+        if (in_tree[start])
+            continue;
+
+        // One tree per connected component
+        for (size_t u = start; u != n;)
+        {
+            in_tree[u] = true;
+            if (cheapest[u])
+                chosen.push_back(cheapest[u]);
+
+            graph.ForValidEdgesOf(vertices[u], [&](const Graph::Details::Edge& edge, size_t i, size_t j)
+            {
+                const auto v = to_local(i == vertices[u] ? j : i);
+                if (!in_tree[v] && is_cheaper(&edge, cheapest[v]))
+                    cheapest[v] = &edge;
+            });
+
+            size_t next = n;
+            for (size_t v = 0; v < n; ++v)
+            {
+                if (!in_tree[v] && cheapest[v] && (next == n || is_cheaper(cheapest[v], cheapest[next])))
+                    next = v;
+            }
+            u = next;
+        }
+    }
+
+    // Contraction waits till the end: edges of a vertex are the edges of its subset, which must not grow during scans
+    std::list<size_t> result{};
+    for (const auto* edge : chosen)
+    {
+        result.push_back(edge->index);
+        graph.Union(edge->i, edge->j);
+    }
+    return result;
+}
+} // namespace MST
@@ -0,0 +1,42 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "MST.h"
+
+#include <Graph.h>
+
+#include <list>
+
+namespace MST
+{
+// Which engine solves graph of this call of recursion according to thresholds of options. Auto engine counts valid
+// edges, which compacts edges of graph
+Engine ChooseEngine(Graph::Graph& graph, const Options& options);
+
+// Direct engines for small subgraphs. All of them consume graph the same way as BoruvkaPhase does: chosen edges are
+// contracted, so graph has one vertex per connected component after the call
+std::list<size_t> BoruvkaMSF(Graph::Graph& graph);
+std::list<size_t> KruskalMSF(Graph::Graph& graph);
+std::list<size_t> PrimMSF(Graph::Graph& graph);
+} // namespace MST
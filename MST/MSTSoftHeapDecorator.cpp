@@ -30,113 +30,207 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <ranges>
+#include <utility>
 
 namespace MST::Details
 {
-MSTSoftHeapDecorator::MSTSoftHeapDecorator(size_t r, std::set<size_t>& bad_edges, size_t index )
-    : m_heap{r,
-             [&](EdgePtrWrapperShared& item, const EdgePtrWrapperShared& ckey)
+MSTSoftHeapDecorator::MSTSoftHeapDecorator(size_t r, std::set<size_t>& bad_edges, size_t index, std::pmr::memory_resource* memory, EdgeItemPool& items, SoftHeapObserver* observer)
+    : m_pool{items}
+    , m_heap{r,
+             [&](EdgeHeapKey& item, const EdgeHeapKey& ckey)
              {
-                 SPDLOG_DEBUG("SetWorking cost for {} cost {}", item.shared_pointer->GetEdge().GetIndex(), ckey.shared_pointer->GetWorkingCost());
-                 if (item.shared_pointer->GetWorkingCost() != ckey.shared_pointer->GetWorkingCost())
+                 auto&      edge = m_pool.Get(item.handle);
+                 const auto cost = UnpackCost(ckey.key);
+                 SPDLOG_DEBUG("SetWorking cost for {} cost {}", edge->GetIndex(), cost);
+                 // Ckey of the same cost but of greater index doesn't change cost. Every edge is reported once
+                 const bool newly_corrupted = edge.GetWorkingCost() != cost && !edge.GetIsCorrupted();
+                 if (edge.GetWorkingCost() != cost)
                  {
-                     SPDLOG_DEBUG("[{}] {} becomes corrupted", m_index, item.shared_pointer->GetEdge().GetIndex());
-                     item.shared_pointer->SetIsCorrupted(true);
-                     bad_edges.emplace(item.shared_pointer->GetEdge().index);
+                     SPDLOG_DEBUG("[{}] {} becomes corrupted", m_index, edge->GetIndex());
+                     edge.SetIsCorrupted(true);
+                     // insert doesn't allocate a node for an edge which is already bad
+                     bad_edges.insert(edge->index);
                  }
-                 item.shared_pointer->SetWorkingCost(ckey.shared_pointer->GetWorkingCost());
-             }}
-    , m_index{index} {}
+                 edge.SetWorkingCost(cost);
+                 item.key = edge.GetKey();
+                 return newly_corrupted;
+             },
+             Allocator{memory}}
+    , m_items{memory}
+    , m_index{index}
+{
+    m_heap.SetObserver(observer);
+}
 
 void MSTSoftHeapDecorator::Insert(EdgePtrWrapper new_key)
 {
     SPDLOG_DEBUG("[{}] New edge {} Cost {} Weight {}", m_index, new_key->GetIndex(), new_key.GetWorkingCost(), new_key->GetWeight());
-    auto ptr = std::make_shared<EdgePtrWrapper>(std::move(new_key));
+    const auto handle = m_pool.Create(std::move(new_key));
+    auto&      item   = m_pool.Get(handle);
+    auto&      items  = m_items.try_emplace(item.GetOutsideVertex()).first->second;
 
-    m_heap.Insert(EdgePtrWrapperShared{ptr});
-    m_items.emplace_back(std::move(ptr));
+    item.list     = m_heap.Insert(EdgeHeapKey{item.GetKey(), handle});
+    item.position = items.insert(items.end(), handle);
+    ++m_size;
 }
 
 EdgePtrWrapper MSTSoftHeapDecorator::DeleteMin()
 {
-    const auto value = m_heap.DeleteMin();
-    auto       ptr   = value.shared_pointer;
+    while (true)
+    {
+        const auto  value = m_heap.DeleteMin();
+        const auto& item  = m_pool.Get(value.handle);
+        m_pool.CountDeleteMin();
 
-    if (!Utils::IsRangeContains(m_items, value.shared_pointer))
-        return DeleteMin();
+        // Removed from decorator earlier, but still was in the heap
+        if (!item.alive)
+            continue;
 
-    SPDLOG_DEBUG("[{}] Remove edge {}  Cost {} Weight {}", m_index, ptr->GetEdge().GetIndex(), ptr->GetWorkingCost(), ptr->GetEdge().GetWeight());
-    m_items.remove(ptr);
-    return *ptr;
+        SPDLOG_DEBUG("[{}] Remove edge {}  Cost {} Weight {}", m_index, item->GetIndex(), item.GetWorkingCost(), item->GetWeight());
+        return Remove(value.handle);
+    }
 }
 
 EdgePtrWrapper* MSTSoftHeapDecorator::FindMin()
 {
-    if (m_items.empty())
+    if (!m_size)
         return {};
 
-    const auto value_ptr = m_heap.FindMin();
-    if (!value_ptr)
-        return {};
-
-    if (Utils::IsRangeContains(m_items, value_ptr->shared_pointer))
+    while (const auto value_ptr = m_heap.FindMin())
     {
-        SPDLOG_DEBUG("[{}] Find min edge {}  Cost {} Weight {}",
-                     m_index,
-                     value_ptr->shared_pointer->GetEdge().GetIndex(),
-                     value_ptr->shared_pointer->GetWorkingCost(),
-                     value_ptr->shared_pointer->GetEdge().GetWeight());
-        return value_ptr->shared_pointer.get();
-    }
+        auto& item = m_pool.Get(value_ptr->handle);
+        if (item.alive)
+        {
+            SPDLOG_DEBUG("[{}] Find min edge {}  Cost {} Weight {}",
+                         m_index,
+                         item->GetIndex(),
+                         item.GetWorkingCost(),
+                         item->GetWeight());
+            return &item;
+        }
 
-    m_heap.DeleteMin();
-    return FindMin();
+        m_heap.DeleteMin();
+        m_pool.CountDeleteMin();
+    }
+    return {};
 }
 
 std::list<EdgePtrWrapper> MSTSoftHeapDecorator::DeleteAndReturnIf(const std::function<bool(const EdgePtrWrapper& edge)>& func)
 {
+    // Returned edges are compared by working cost
+    m_heap.Flush();
+
     std::list<EdgePtrWrapper> result{};
-    for (auto itr = m_items.begin(); itr != m_items.end();)
+    for (auto vertex_itr = m_items.begin(); vertex_itr != m_items.end();)
     {
-        if (func(**itr))
+        auto& items = vertex_itr->second;
+        for (auto itr = items.begin(); itr != items.end();)
         {
+            auto& item = m_pool.Get(*itr);
+            if (!func(item))
+            {
+                ++itr;
+                continue;
+            }
+
             SPDLOG_DEBUG("[{}] Delete edge {}  Cost {} Weight {}",
                          m_index,
-                         (*itr)->GetEdge().GetIndex(),
-                         (*itr)->GetWorkingCost(),
-                         (*itr)->GetEdge().GetWeight());
-            result.emplace_back(**itr);
-            itr = m_items.erase(itr);
+                         item.GetEdge().GetIndex(),
+                         item.GetWorkingCost(),
+                         item.GetEdge().GetWeight());
+            item.alive = false;
+            item.list.reset();
+            result.emplace_back(item);
+            itr = items.erase(itr);
+            --m_size;
         }
-        else
-            ++itr;
+        vertex_itr = items.empty() ? m_items.erase(vertex_itr) : std::next(vertex_itr);
     }
+    // Order of vertices in the hash map depends on hashing, result must not
+    result.sort();
     return result;
 }
 
+std::list<EdgePtrWrapper> MSTSoftHeapDecorator::DeleteAndReturnByOutsideVertex(size_t outside_vertex)
+{
+    const auto vertex_itr = m_items.find(outside_vertex);
+    if (vertex_itr == m_items.end())
+        return {};
+
+    std::list<EdgePtrWrapper> result{};
+    for (const auto handle : vertex_itr->second)
+    {
+        auto& item = m_pool.Get(handle);
+        SPDLOG_DEBUG("[{}] Delete edge {} by outside vertex {}", m_index, item.GetEdge().GetIndex(), outside_vertex);
+        // Returned edges are compared by working cost: postponed raise of ckey is applied to them only
+        EdgeHeapKey value{item.GetKey(), handle};
+        m_heap.Flush(value, item.list);
+        item.list.reset();
+        item.alive = false;
+        result.emplace_back(item);
+    }
+    m_size -= vertex_itr->second.size();
+    m_items.erase(vertex_itr);
+    return result;
+}
+
+EdgePtrWrapper MSTSoftHeapDecorator::Remove(uint32_t handle)
+{
+    auto&      item       = m_pool.Get(handle);
+    const auto vertex_itr = m_items.find(item.GetOutsideVertex());
+    item.alive            = false;
+    item.list.reset();
+    vertex_itr->second.erase(item.position);
+    if (vertex_itr->second.empty())
+        m_items.erase(vertex_itr);
+    --m_size;
+    return item;
+}
+
 void MSTSoftHeapDecorator::Meld(MSTSoftHeapDecorator& other)
 {
-    m_items.splice(m_items.end(), other.m_items);
+    // Positions stay valid: list nodes are moved between lists with the same resource
+    for (auto& [vertex, items] : other.m_items)
+    {
+        auto& to = m_items.try_emplace(vertex).first->second;
+        to.splice(to.end(), items);
+    }
+    other.m_items.clear();
+
+    m_size += std::exchange(other.m_size, 0);
     m_heap.Meld(other.m_heap);
 }
 
 MSTSoftHeapDecorator::ExtractedItems MSTSoftHeapDecorator::ExtractItems()
 {
-    ExtractedItems to_out{};
+    m_heap.Flush();
 
-    for (auto& edge : m_items)
+    ExtractedItems to_out{};
+    for (auto& items : m_items | std::views::values)
     {
-       if (edge->GetIsCorrupted())
-            to_out.corrupted.push_back(*edge);
-        else
-            to_out.items.push_back(*edge);
+        for (const auto handle : items)
+        {
+            auto& edge = m_pool.Get(handle);
+            edge.alive = false;
+            edge.list.reset();
+            if (edge.GetIsCorrupted())
+                to_out.corrupted.push_back(edge);
+            else
+                to_out.items.push_back(edge);
+        }
     }
 
+    // Order of vertices in the hash map depends on hashing, output must not
+    to_out.corrupted.sort();
+    to_out.items.sort();
+
     for (auto& edge : to_out.corrupted)
         SPDLOG_DEBUG("[{}] Corrupted edge {} original {} current {}", m_index, edge->GetIndex(), edge->GetWeight(), edge.GetWorkingCost());
     for (auto& edge : to_out.items)
         SPDLOG_DEBUG("[{}] Normal edge {} original {} current {}", m_index, edge->GetIndex(), edge->GetWeight(), edge.GetWorkingCost());
     m_items.clear();
+    m_size = 0;
     return to_out;
 }
 } // namespace MST::Details
@@ -25,15 +25,36 @@
 #include <SoftHeapCpp.h>
 
 #include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <memory>
+#include <memory_resource>
 #include <optional>
 #include <ostream>
 #include <set>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 
 namespace MST::Details
 {
 using Label = std::array<std::optional<size_t>, 2>;
 
+// Working cost in high half and edge index in low one: integer order is order by cost with ties broken by index.
+// Both must fit into 32 bits, FindMST replaces larger weights and indexes by their ranks. Truncated keys would make
+// different edges equal, so they are rejected
+inline uint64_t PackKey(size_t cost, size_t index)
+{
+    if (cost > std::numeric_limits<uint32_t>::max() || index > std::numeric_limits<uint32_t>::max())
+        throw std::invalid_argument{"Working cost and index of edge in soft heap must fit into 32 bits"};
+    return static_cast<uint64_t>(cost) << 32 | static_cast<uint64_t>(index);
+}
+
+inline size_t UnpackCost(uint64_t key) { return static_cast<size_t>(key >> 32); }
+
 class EdgePtrWrapper
 {
 public:
@@ -46,12 +67,13 @@ public:
 
     size_t GetOutsideVertex() const { return m_outside_vertex; }
 
-    bool operator<(const EdgePtrWrapper& rhs) const { return m_working_cost < rhs.m_working_cost; }
-    bool operator<=(const EdgePtrWrapper& rhs) const { return m_working_cost <= rhs.m_working_cost; }
+    bool operator<(const EdgePtrWrapper& rhs) const { return GetKey() < rhs.GetKey(); }
+    bool operator<=(const EdgePtrWrapper& rhs) const { return GetKey() <= rhs.GetKey(); }
     bool operator==(const EdgePtrWrapper& rhs) const { return m_edge == rhs.m_edge; }
 
     void   SetWorkingCost(size_t cost) { m_working_cost = cost; }
     size_t GetWorkingCost() const { return m_working_cost; }
+    uint64_t GetKey() const { return PackKey(m_working_cost, m_edge->index); }
 
     void SetIsCorrupted(bool corrupted) { m_is_corrupted = corrupted; }
     bool GetIsCorrupted() const {return m_is_corrupted; };
@@ -62,26 +84,79 @@ private:
     bool                              m_is_corrupted = false;
 };
 
-struct EdgePtrWrapperShared
+// Value stored by soft heap: packed key is compared inline, handle refers to item in EdgeItemPool
+struct EdgeHeapKey
 {
-    EdgePtrWrapperShared(const std::shared_ptr<EdgePtrWrapper>& value)
-        : shared_pointer{value} {}
+    bool operator<(const EdgeHeapKey& rhs) const { return key < rhs.key; }
+
+    uint64_t key;
+    uint32_t handle;
+};
+
+using EdgeHeap = SoftHeapCpp<EdgeHeapKey, std::pmr::polymorphic_allocator<EdgeHeapKey>>;
 
-    bool operator<(const EdgePtrWrapperShared& rhs) const { return *shared_pointer < *rhs.shared_pointer; }
-    bool operator==(const EdgePtrWrapperShared& rhs) const { return *shared_pointer == *rhs.shared_pointer; }
+// Edge owned by decorator. Items stay in the soft heap after removal from decorator until the heap pops them, so
+// alive flag tells if item is still a member and position allows to erase it from the list of items of its outside
+// vertex in O(1). List of the heap finds the current ckey of a member without a walk over the heap
+struct EdgeHeapItem : EdgePtrWrapper
+{
+    EdgeHeapItem(EdgePtrWrapper edge)
+        : EdgePtrWrapper{std::move(edge)} {}
+
+    std::pmr::list<uint32_t>::iterator position{};
+    EdgeHeap::ListRef                  list{};
+    bool                               alive = true;
+};
+
+// Items of all heaps of one tree build, addressed by 32-bit handles. Slots are not reused during the build, all items
+// are released together. Items refer to lists of their heaps, so the pool must be destroyed before memory of the heaps
+class EdgeItemPool
+{
+public:
+    EdgeItemPool() = default;
+    EdgeItemPool(const EdgeItemPool&)            = delete;
+    EdgeItemPool& operator=(const EdgeItemPool&) = delete;
 
-    friend std::ostream& operator<<(std::ostream& os, const EdgePtrWrapperShared& obj)
+    ~EdgeItemPool()
     {
-        return os << "Edge: " << obj.shared_pointer->GetEdge().index << std::endl;
+        for (size_t handle = 0; handle < m_size; ++handle)
+            std::destroy_at(&Get(handle));
+        for (auto* slab : m_slabs)
+            std::allocator<EdgeHeapItem>{}.deallocate(slab, slab_size);
     }
 
-    std::shared_ptr<EdgePtrWrapper> shared_pointer;
+    uint32_t Create(EdgePtrWrapper edge)
+    {
+        if (m_size == std::numeric_limits<uint32_t>::max())
+            throw std::length_error("Too many edges in heaps of one tree");
+
+        if (m_size % slab_size == 0)
+            m_slabs.emplace_back(std::allocator<EdgeHeapItem>{}.allocate(slab_size));
+
+        std::construct_at(&Get(m_size), std::move(edge));
+        return static_cast<uint32_t>(m_size++);
+    }
+
+    EdgeHeapItem& Get(size_t handle) const { return m_slabs[handle / slab_size][handle % slab_size]; }
+    // Every insert into heaps of the pool creates an item, so size is also count of inserts
+    size_t        GetSize() const { return m_size; }
+
+    void   CountDeleteMin() { ++m_deletes; }
+    size_t GetDeletesCount() const { return m_deletes; }
+
+private:
+    static constexpr size_t slab_size = 4096;
+
+    std::vector<EdgeHeapItem*> m_slabs{};
+    size_t                     m_size{};
+    size_t                     m_deletes{};
 };
 
 class MSTSoftHeapDecorator
 {
 public:
-    explicit MSTSoftHeapDecorator(size_t r, std::set<size_t>& bad_edges, size_t index);
+    // Heaps which are melded together must share the same memory resource and pool of items
+    explicit MSTSoftHeapDecorator(size_t r, std::set<size_t>& bad_edges, size_t index, std::pmr::memory_resource* memory, EdgeItemPool& items, SoftHeapObserver* observer = nullptr);
 
     struct ExtractedItems
     {
@@ -97,10 +172,22 @@ public:
     EdgePtrWrapper* FindMin();
 
     std::list<EdgePtrWrapper> DeleteAndReturnIf(const std::function<bool(const EdgePtrWrapper& edge)>& func);
+    // Same as DeleteAndReturnIf for edges with such outside vertex, but visits only them
+    std::list<EdgePtrWrapper> DeleteAndReturnByOutsideVertex(size_t outside_vertex);
+
+    size_t GetSize() const { return m_size; }
+
+private:
+    EdgePtrWrapper Remove(uint32_t handle);
 
 private:
-    SoftHeapCpp<EdgePtrWrapperShared>          m_heap;
-    std::list<std::shared_ptr<EdgePtrWrapper>> m_items{};
-    size_t                                     m_index;
+    using Allocator = EdgeHeap::allocator_type;
+    using Items     = std::pmr::list<uint32_t>;
+
+    EdgeItemPool&                          m_pool;
+    EdgeHeap                               m_heap;
+    std::pmr::unordered_map<size_t, Items> m_items; // outside vertex -> handles of items
+    size_t                                       m_size{};
+    size_t                                       m_index;
 };
 }
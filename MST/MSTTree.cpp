@@ -49,9 +49,11 @@ static std::vector<size_t> InitTargetSizesPerHeight(size_t t, size_t max_height)
 
 namespace MST::Details
 {
-MSTTree::MSTTree(Graph::Graph& graph, size_t t, size_t max_height,size_t initial_vertex)
+MSTTree::MSTTree(Graph::Graph& graph, size_t t, size_t max_height, size_t r, size_t initial_vertex, SoftHeapObserver* heap_observer)
     : m_graph{graph}
-    , m_r{Utils::CalculateRByEps(1 / static_cast<double>(MST::c))}
+    , m_path_min{max_height + 1}
+    , m_r{r}
+    , m_heap_observer{heap_observer}
     , m_sizes_per_height{InitTargetSizesPerHeight(t, max_height)}
 {
     PushNode(initial_vertex);
@@ -77,7 +79,7 @@ MSTSoftHeapDecorator::ExtractedItems MSTTree::pop()
     {
         m_active_path.emplace_front(std::make_shared<SubGraph>(last_subgraph,
                                     m_sizes_per_height[IndexToHeight(last_subgraph->GetLevelInTree() - 1)],
-                                    m_r, m_bad_edges));
+                                    m_r, m_bad_edges, &m_heaps_memory, m_heap_items, m_path_min, m_heap_observer));
     }
 
     (*std::next(m_active_path.rbegin()))->MeldHeapsFrom(last_subgraph);
@@ -131,28 +133,40 @@ ISubGraph& MSTTree::top()
     return *m_active_path.back();
 }
 
+std::optional<EdgePtrWrapper> MSTTree::DeleteExtensionEdge()
+{
+    const auto level = m_path_min.Top();
+    if (level == m_path_min.npos)
+        return {};
+
+    // Levels of active path are consecutive
+    assert(level >= m_active_path.front()->GetLevelInTree() && level <= m_active_path.back()->GetLevelInTree());
+    const auto& node = *std::next(m_active_path.begin(), static_cast<std::ptrdiff_t>(level - m_active_path.front()->GetLevelInTree()));
+    return node->DeleteMin();
+}
+
 size_t MSTTree::size() const { return m_active_path.empty() ? 0 : m_active_path.back()->GetLevelInTree() + 1; }
 
 std::list<Graph::Graph> MSTTree::CreateSubGraphs(const std::set<size_t>& bad_edges)
 {
+    UTILS_PROFILE_SCOPE("CreateSubGraphs");
     std::list list_of_subgraphs{m_active_path.front()};
     std::list<Graph::Graph> result{};
+    std::vector<size_t>     edges{};
     while(!list_of_subgraphs.empty())
     {
         auto& front = list_of_subgraphs.front();
-        auto& graph = result.emplace_back();
 
+        edges.clear();
         for (const auto& edge_index : front->GetChildsEdges())
         {
-            if (Utils::IsRangeContains(bad_edges, edge_index))
-                continue;
-
-            auto& edge  = m_graph.GetEdge(edge_index);
-            auto i = m_graph.GetRoot(edge.i);
-            auto j = m_graph.GetRoot(edge.j);
-            graph.AddEdge(i, j, edge.w, edge.index);
+            if (!Utils::IsRangeContains(bad_edges, edge_index))
+                edges.push_back(edge_index);
         }
 
+        // Subgraph shares edges with m_graph, only union-find over its own vertices is created
+        auto& graph = result.emplace_back(m_graph, edges);
+
         for(auto& child : front->GetChilds())
         {
             list_of_subgraphs.emplace_back(child);
@@ -187,7 +201,7 @@ void MSTTree::PushNode(size_t vertex)
     m_active_path.emplace_back(std::make_shared<SubGraph>(vertex,
                                index,
                                m_sizes_per_height[IndexToHeight(index)],
-                               m_r, m_bad_edges));
+                               m_r, m_bad_edges, &m_heaps_memory, m_heap_items, m_path_min, m_heap_observer));
 
     AddNewBorderEdgesAfterPush();
     DeleteOldBorderEdgesAndUpdateMinLinksAfterPush();
@@ -197,36 +211,26 @@ void MSTTree::AddNewBorderEdgesAfterPush()
 {
     auto& new_node      = m_active_path.back();
     auto  node_vertices = new_node->GetVertices();
-    auto all_vertices = m_active_path.front()->GetVertices();
 
     assert(node_vertices.size() == 1);
+    const auto vertex = node_vertices.front();
+    m_vertices_inside.emplace(vertex);
 
     std::unordered_map<size_t, const Graph::Details::Edge*> cheapest_edge_per_vertex{};
-    m_graph.ForValidEdges([&](const Graph::Details::Edge& edge, size_t i, size_t j)
+    m_graph.ForValidEdgesOf(vertex, [&](const Graph::Details::Edge& edge, size_t i, size_t j)
     {
-        if (Utils::IsRangeContains(node_vertices, i))
-        {
-            if (!Utils::IsRangeContains(all_vertices, j))
-            {
-                auto& v = cheapest_edge_per_vertex[j];
-                if (!v || v->w > edge.w)
-                    v = &edge;
-            }
-        }
-        else if (Utils::IsRangeContains(node_vertices, j))
-        {
-            if (!Utils::IsRangeContains(all_vertices, i))
-            {
-                auto& v = cheapest_edge_per_vertex[i];
-                if (!v || v->w > edge.w)
-                    v = &edge;
-            }
-        }
+        const auto outside_vertex = i == vertex ? j : i;
+        if (m_vertices_inside.contains(outside_vertex))
+            return;
+
+        auto& v = cheapest_edge_per_vertex[outside_vertex];
+        if (!v || v->w > edge.w)
+            v = &edge;
     });
 
-    for (const auto& [vertex, edge] : cheapest_edge_per_vertex)
+    for (const auto& [outside_vertex, edge] : cheapest_edge_per_vertex)
     {
-        new_node->PushToHeap(EdgePtrWrapper{edge, vertex});
+        new_node->PushToHeap(EdgePtrWrapper{edge, outside_vertex});
     }
 }
 
@@ -236,20 +240,16 @@ void MSTTree::DeleteOldBorderEdgesAndUpdateMinLinksAfterPush()
     if (m_active_path.size() <= 1)
         return;
 
-    auto condition = [&, vertex = new_node->GetVertices().back()](const EdgePtrWrapper& edge)
-    {
-         auto   i      = m_graph.GetRoot(edge->i);
-         auto   j      = m_graph.GetRoot(edge->j);
-        return i == vertex || j == vertex;
-    };
-
-    SPDLOG_DEBUG("Condition: edge with node {} ", new_node->GetVertices().back());
+    // Old border edges to the new vertex are exactly edges with it as outside vertex: roots of graph don't change
+    // while tree is built and the vertex was outside of the tree before push
+    const auto vertex = new_node->GetVertices().back();
+    SPDLOG_DEBUG("Delete border edges with node {} ", vertex);
 
     std::for_each_n(m_active_path.begin(),
                     m_active_path.size() - 1,
                     [&](SubGraphPtr& node)
                     {
-                        const auto old_border_edges = node->DeleteAndReturnIf(condition);
+                        const auto old_border_edges = node->DeleteAndReturnByOutsideVertex(vertex);
                         if (old_border_edges.empty())
                             return;
 
@@ -25,8 +25,11 @@
 #include "MSTSoftHeapDecorator.h"
 #include "MSTTreeSubgraph.h"
 
+#include <AllocTracker.h>
 #include <Graph.h>
 
+#include <memory_resource>
+#include <unordered_set>
 #include <vector>
 
 namespace MST::Details
@@ -34,7 +37,8 @@ namespace MST::Details
 class MSTTree
 {
 public:
-    MSTTree(Graph::Graph& graph, size_t t, size_t max_height, size_t initial_vertex);
+    // Heap observer watches all heaps of the tree, it must outlive the tree
+    MSTTree(Graph::Graph& graph, size_t t, size_t max_height, size_t r, size_t initial_vertex, SoftHeapObserver* heap_observer = nullptr);
 
     void push(const EdgePtrWrapper& extension_edge);
 
@@ -46,6 +50,9 @@ public:
     ISubGraph& top();
     size_t     size() const;
 
+    // DeleteMin from the heap with minimal edge among all nodes of active path, nullopt if all of them are empty
+    std::optional<EdgePtrWrapper> DeleteExtensionEdge();
+
     auto view()
     {
         return std::ranges::views::transform(m_active_path,
@@ -67,6 +74,7 @@ public:
     std::list<Graph::Graph> CreateSubGraphs(const std::set<size_t>& bad_edges);
     std::list<size_t>       GetVerticesInside();
     const std::set<size_t>& GetBadEdges() const { return m_bad_edges; }
+    const EdgeItemPool&     GetHeapItems() const { return m_heap_items; }
 private:
     void PushNode(size_t vertex);
 
@@ -76,11 +84,21 @@ private:
     size_t GetMaxHeight() const { return m_sizes_per_height.size() - 1; }
     size_t IndexToHeight(size_t index) const { return GetMaxHeight() - index; }
 private:
-    Graph::Graph&          m_graph;
-    std::list<SubGraphPtr> m_active_path{};
+    Graph::Graph& m_graph;
+
+    // Nodes of all soft heaps in the tree are recycled through this pool and their items are kept in m_heap_items,
+    // so both must outlive the active path
+    Utils::Alloc::ComponentResource        m_heaps_upstream{Utils::Alloc::Component::SoftHeap};
+    std::pmr::unsynchronized_pool_resource m_heaps_memory{&m_heaps_upstream};
+    EdgeItemPool                           m_heap_items{};
+    PathMin                                m_path_min;
+    std::list<SubGraphPtr>                 m_active_path{};
     std::set<size_t>       m_bad_edges{};
 
+    std::unordered_set<size_t> m_vertices_inside{};
+
     const size_t              m_r;
+    SoftHeapObserver*         m_heap_observer;
     const std::vector<size_t> m_sizes_per_height;
 };
 }
@@ -22,6 +22,7 @@
 
 #include "MSTTreeBuilder.h"
 
+#include <Common.h>
 #include <Graph.h>
 
 //#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_DEBUG
@@ -30,10 +31,11 @@
 
 namespace MST
 {
-MSTTreeBuilder::MSTTreeBuilder(Graph::Graph& graph, size_t t, size_t max_height, size_t initial_vertex)
+MSTTreeBuilder::MSTTreeBuilder(Graph::Graph& graph, size_t t, size_t max_height, size_t r, size_t initial_vertex, SoftHeapObserver* heap_observer)
     : m_graph{graph}
-    , m_tree{m_graph, t, max_height, initial_vertex}
+    , m_tree{m_graph, t, max_height, r, initial_vertex, heap_observer}
 {
+    UTILS_PROFILE_SCOPE("MSTTreeBuilder");
     while (true)
     {
         if (m_tree.top().IsMeetTargetSize())
@@ -57,21 +59,21 @@ bool MSTTreeBuilder::Retraction()
         return false;
 
     PostRetractionActions(m_tree.pop());
+    ++m_counters.retractions;
     return true;
 }
 
 bool MSTTreeBuilder::Extension()
 {
-    const auto extension_heap = FindHeapWithExtensionEdge();
-    SPDLOG_DEBUG("Extension heap {}", !!extension_heap);
-    if (!extension_heap)
+    auto edge = m_tree.DeleteExtensionEdge();
+    SPDLOG_DEBUG("Extension edge {}", edge.has_value());
+    if (!edge)
         return false;
 
-    auto edge = extension_heap->DeleteMin();
+    PostRetractionActions(Fusion(*edge));
 
-    PostRetractionActions(Fusion(edge));
-
-    m_tree.push(edge);
+    m_tree.push(*edge);
+    ++m_counters.extensions;
 
     return true;
 }
@@ -105,24 +107,6 @@ void MSTTreeBuilder::CreateClustersAndPushCheapest(std::list<Details::EdgePtrWra
     }
 }
 
-Details::MSTSoftHeapDecorator* MSTTreeBuilder::FindHeapWithExtensionEdge()
-{
-    auto stack_view = m_tree.view();
-    auto transformed_stack_view = rgv::transform(stack_view, &Details::ISubGraph::FindHeapWithMin);
-    const auto min_element = rg::min_element(transformed_stack_view,
-                                             [](Details::MSTSoftHeapDecorator* left,
-                                                Details::MSTSoftHeapDecorator* right)
-                                             {
-                                                 if (!left)
-                                                     return false;
-                                                 if (!right)
-                                                     return true;
-                                                 return *left->FindMin() < *right->FindMin();
-                                             });
-
-    return *min_element;
-}
-
 Details::MSTSoftHeapDecorator::ExtractedItems MSTTreeBuilder::Fusion(Details::EdgePtrWrapper& extension_edge)
 {
     const auto view = m_tree.view();
@@ -138,6 +122,7 @@ Details::MSTSoftHeapDecorator::ExtractedItems MSTTreeBuilder::Fusion(Details::Ed
         if (edge_itr != min_links.cend())
         {
             SPDLOG_DEBUG("Fusion for edge {}", extension_edge->GetIndex());
+            ++m_counters.fusions;
             return m_tree.fusion(itr.base(), *edge_itr);
         }
     }
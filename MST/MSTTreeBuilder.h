@@ -30,21 +30,29 @@ namespace MST
 class MSTTreeBuilder
 {
 public:
-    MSTTreeBuilder(Graph::Graph& graph, size_t t, size_t max_height, size_t initial_vertex);
+    MSTTreeBuilder(Graph::Graph& graph, size_t t, size_t max_height, size_t r, size_t initial_vertex, SoftHeapObserver* heap_observer = nullptr);
+
+    struct Counters
+    {
+        size_t extensions{};
+        size_t retractions{};
+        size_t fusions{};
+    };
 
     MST::Details::MSTTree& GetTree() { return m_tree; }
+    const Counters&        GetCounters() const { return m_counters; }
 private:
     // Pop last node from stack, discard corrupted edges, for rest create clusters and insert cheapest to heap
     bool Retraction();
     bool Extension();
 
-    void                           CreateClustersAndPushCheapest(std::list<Details::EdgePtrWrapper>&& items);
-    Details::MSTSoftHeapDecorator* FindHeapWithExtensionEdge();
+    void CreateClustersAndPushCheapest(std::list<Details::EdgePtrWrapper>&& items);
 
     Details::MSTSoftHeapDecorator::ExtractedItems Fusion(Details::EdgePtrWrapper& edge);
     void PostRetractionActions(Details::MSTSoftHeapDecorator::ExtractedItems items);
 private:
     Graph::Graph&    m_graph;
     Details::MSTTree m_tree;
+    Counters         m_counters{};
 };
 }
@@ -28,22 +28,30 @@
 
 namespace MST::Details
 {
-SubGraph::SubGraph(size_t vertex, size_t level_in_tree, size_t target_size, size_t r, std::set<size_t>& bad_edges)
+SubGraph::SubGraph(size_t vertex, size_t level_in_tree, size_t target_size, size_t r, std::set<size_t>& bad_edges, std::pmr::memory_resource* memory, EdgeItemPool& items, PathMin& path_min, SoftHeapObserver* heap_observer)
     : m_vertex{vertex}
     , m_level_in_tree{level_in_tree}
     , m_target_size{target_size}
     , m_r{r}
+    , m_path_min{path_min}
     , m_bad_edges{bad_edges}
+    , m_memory{memory}
+    , m_items{items}
+    , m_heap_observer{heap_observer}
 {
     InitHeaps();
 }
 
-SubGraph::SubGraph(const SubGraphPtr& child, size_t target_size, size_t r, std::set<size_t>& bad_edges)
+SubGraph::SubGraph(const SubGraphPtr& child, size_t target_size, size_t r, std::set<size_t>& bad_edges, std::pmr::memory_resource* memory, EdgeItemPool& items, PathMin& path_min, SoftHeapObserver* heap_observer)
     : m_level_in_tree{child->GetLevelInTree() - 1}
     , m_target_size{target_size}
     , m_r{r}
     , m_childs{{std::nullopt, child}}
+    , m_path_min{path_min}
     , m_bad_edges{bad_edges}
+    , m_memory{memory}
+    , m_items{items}
+    , m_heap_observer{heap_observer}
 {
     InitHeaps();
 }
@@ -53,9 +61,21 @@ void SubGraph::InitHeaps()
     m_heaps.reserve(m_level_in_tree + 1);
 
     for (size_t i = 0; i < m_level_in_tree + 1; ++i)
-        m_heaps.emplace_back(m_r, m_bad_edges, m_level_in_tree);
+        m_heaps.emplace_back(m_r, m_bad_edges, m_level_in_tree, m_memory, m_items, m_heap_observer);
 
     m_heaps.shrink_to_fit();
+
+    m_heaps_min = Utils::TournamentTree<uint64_t>{m_heaps.size()};
+    m_path_min.Update(m_level_in_tree, std::nullopt);
+}
+
+void SubGraph::UpdateMin(size_t heap)
+{
+    const auto* min = m_heaps[heap].FindMin();
+    m_heaps_min.Update(heap, min ? std::optional{min->GetKey()} : std::nullopt);
+
+    const auto top = m_heaps_min.Top();
+    m_path_min.Update(m_level_in_tree, top == m_heaps_min.npos ? std::nullopt : m_heaps_min.Get(top));
 }
 
 size_t SubGraph::GetLevelInTree() const
@@ -91,13 +111,18 @@ std::list<size_t> SubGraph::GetVertices(bool cache)
 void SubGraph::PushToHeap(EdgePtrWrapper edge)
 {
     m_heaps[m_level_in_tree].Insert(edge);
+    UpdateMin(m_level_in_tree);
 }
 
 void SubGraph::MeldHeapsFrom(SubGraphPtr& other)
 {
     // m_level_in_tree = other.m_level_in_tree - 1
     for (size_t i = 0; i < m_level_in_tree; ++i)
+    {
         m_heaps[i].Meld(other->m_heaps[i]);
+        UpdateMin(i);
+        other->UpdateMin(i);
+    }
 }
 
 void SubGraph::AddToMinLinks(const EdgePtrWrapper& edge)
@@ -146,26 +171,33 @@ SubGraphPtr SubGraph::PopLastChild()
 
 MSTSoftHeapDecorator* SubGraph::FindHeapWithMin()
 {
-    auto* min_heap  = &m_heaps.front();
-    auto  min_value = min_heap->FindMin();
-    for (auto& heap : m_heaps | rgv::drop(1))
-    {
-        const auto new_value = heap.FindMin();
-        if (!min_value || new_value && *new_value < *min_value)
-        {
-            min_heap  = &heap;
-            min_value = new_value;
-        }
-    }
-    return min_value ? min_heap : nullptr;
+    const auto top = m_heaps_min.Top();
+    return top == m_heaps_min.npos ? nullptr : &m_heaps[top];
 }
 
+std::optional<EdgePtrWrapper> SubGraph::DeleteMin()
+{
+    const auto top = m_heaps_min.Top();
+    if (top == m_heaps_min.npos)
+        return {};
+
+    auto edge = m_heaps[top].DeleteMin();
+    UpdateMin(top);
+    return edge;
+}
 
-std::list<EdgePtrWrapper> SubGraph::DeleteAndReturnIf(const std::function<bool(const EdgePtrWrapper& edge)>& func)
+std::list<EdgePtrWrapper> SubGraph::DeleteAndReturnByOutsideVertex(size_t outside_vertex)
 {
     std::list<EdgePtrWrapper> result{};
-    for (auto& heap : m_heaps)
-        result.splice(result.end(), heap.DeleteAndReturnIf(func));
+    for (size_t i = 0; i < m_heaps.size(); ++i)
+    {
+        auto deleted = m_heaps[i].DeleteAndReturnByOutsideVertex(outside_vertex);
+        if (deleted.empty())
+            continue;
+
+        result.splice(result.end(), deleted);
+        UpdateMin(i);
+    }
     return result;
 }
 } // namespace MST::Details
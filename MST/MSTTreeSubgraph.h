@@ -23,6 +23,8 @@
 #pragma once
 #include "MSTSoftHeapDecorator.h"
 
+#include <TournamentTree.h>
+
 #include <ranges>
 #include <set>
 
@@ -33,6 +35,10 @@ namespace MST::Details
 {
 class SubGraph;
 
+// Key of minimal edge per node of active path, node of level k is leaf k. Keys break ties of working costs by index
+// the same way as heaps do
+using PathMin = Utils::TournamentTree<uint64_t>;
+
 struct ISubGraph
 {
     virtual ~ISubGraph() { }
@@ -52,8 +58,8 @@ using SubGraphPtr = std::shared_ptr<SubGraph>;
 class SubGraph : public ISubGraph
 {
 public:
-    SubGraph(size_t vertex, size_t level_in_tree, size_t target_size, size_t r, std::set<size_t>& bad_edges);
-    SubGraph(const SubGraphPtr& child, size_t target_size, size_t r, std::set<size_t>& bad_edges);
+    SubGraph(size_t vertex, size_t level_in_tree, size_t target_size, size_t r, std::set<size_t>& bad_edges, std::pmr::memory_resource* memory, EdgeItemPool& items, PathMin& path_min, SoftHeapObserver* heap_observer = nullptr);
+    SubGraph(const SubGraphPtr& child, size_t target_size, size_t r, std::set<size_t>& bad_edges, std::pmr::memory_resource* memory, EdgeItemPool& items, PathMin& path_min, SoftHeapObserver* heap_observer = nullptr);
 
     SubGraph(SubGraph&& other)                 = delete;
     SubGraph(const SubGraph& other)            = delete;
@@ -85,10 +91,14 @@ public:
                 | rgv::transform([](const std::optional<size_t>& v){return v.value();});
     }
 
-    std::list<EdgePtrWrapper> DeleteAndReturnIf(const std::function<bool(const EdgePtrWrapper& edge)>& func);
+    std::list<EdgePtrWrapper> DeleteAndReturnByOutsideVertex(size_t outside_vertex);
+    // DeleteMin from heap with minimal edge, nullopt if all heaps are empty
+    std::optional<EdgePtrWrapper> DeleteMin();
 
 private:
     void InitHeaps();
+    // Every change of heaps must be followed by update of their keys in m_heaps_min and m_path_min
+    void UpdateMin(size_t heap);
 private:
     const std::optional<size_t> m_vertex;
     const size_t                m_level_in_tree; // aka k
@@ -98,9 +108,15 @@ private:
     std::vector<std::pair<std::optional<size_t>, SubGraphPtr>> m_childs{}; // chain-link + child
 
     std::vector<MSTSoftHeapDecorator> m_heaps; // i < m_index -> H(i, m_index) cross heap, else - H(m_index)
+    Utils::TournamentTree<uint64_t>   m_heaps_min{};
+    PathMin&                          m_path_min;
     std::vector<EdgePtrWrapper>       m_min_links_to_next_nodes_in_active_path{};
 
     std::list<size_t> m_cached_verticies{};
     std::set<size_t>& m_bad_edges;
+
+    std::pmr::memory_resource* m_memory;
+    EdgeItemPool&              m_items;
+    SoftHeapObserver*          m_heap_observer;
 };
 }
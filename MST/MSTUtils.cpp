@@ -26,53 +26,98 @@
 //#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_DEBUG
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
+#include <limits>
 #include <stdexcept>
 
 namespace MST
 {
-static uint32_t Ackermann(uint32_t i, uint32_t j)
+namespace
 {
-    static std::map<uint32_t, std::map<uint32_t, std::optional<uint32_t>>> s_result{};
-    auto& result = s_result[i][j];
-    if (result.has_value())
-        return result.value();
+constexpr uint32_t saturated = std::numeric_limits<uint32_t>::max();
 
+// Ackermann function A(0, j) = 2j, A(i, 0) = 0, A(i, 1) = 2, A(i, j) = A(i - 1, A(i, j - 1)) saturated at uint32 max.
+// Every row after the first one saturates before the last column and rows stop changing after the fourth one, so
+// table with lookup below covers all arguments
+constexpr size_t ackermann_rows    = 6;
+constexpr size_t ackermann_columns = 64;
+
+using AckermannTable = std::array<std::array<uint32_t, ackermann_columns>, ackermann_rows>;
+
+constexpr uint32_t Lookup(const AckermannTable& table, uint32_t i, uint32_t j)
+{
     if (i == 0)
-        result = 2*j;
-    else if (j == 0)
-        result = 0;
-    else if (j == 1)
-        result = 2;
-    else
-        result = Ackermann(i - 1, Ackermann(i, j - 1));
-
-    return result.value();
+        return j >= saturated / 2 ? saturated : 2 * j;
+    if (j >= ackermann_columns)
+        return saturated;
+    return table[std::min<size_t>(i, ackermann_rows - 1)][j];
 }
 
-
-static uint32_t S(uint32_t i, uint32_t j)
+constexpr AckermannTable MakeAckermannTable()
 {
-    return Ackermann(i-1, j);
-    static std::map<uint32_t, std::map<uint32_t, std::optional<uint32_t>>> s_result{};
+    AckermannTable table{};
+    for (uint32_t j = 0; j < ackermann_columns; ++j)
+        table[0][j] = Lookup(table, 0, j);
+
+    for (uint32_t i = 1; i < ackermann_rows; ++i)
+    {
+        table[i][0] = 0;
+        table[i][1] = 2;
+        for (uint32_t j = 2; j < ackermann_columns; ++j)
+            table[i][j] = Lookup(table, i - 1, table[i][j - 1]);
+    }
+    return table;
+}
 
-    auto& result = s_result[i][j];
-    if (i == 0 || j == 0)
-        throw std::out_of_range{"i and j must be > 0"};
+constexpr AckermannTable ackermann_table = MakeAckermannTable();
 
-    if (i == 1)
-        result = Ackermann(i-1, j);
-    else if (j == 1)
-        result = Ackermann(i-1, j);
-    else
-        result = S(i, j - 1)*S(i - 1, S(i, j - 1));
+static_assert(ackermann_table[1][ackermann_columns - 1] == saturated, "columns after the table must be saturated");
+static_assert(ackermann_table[ackermann_rows - 1] == ackermann_table[ackermann_rows - 2], "rows after the table must be the same");
 
-    return result.value();
+constexpr uint32_t Ackermann(uint32_t i, uint32_t j) { return Lookup(ackermann_table, i, j); }
+
+static_assert(Ackermann(0, 5) == 10);
+static_assert(Ackermann(1, 10) == 1024);
+static_assert(Ackermann(1, 32) == saturated);
+static_assert(Ackermann(2, 3) == 16);
+static_assert(Ackermann(2, 4) == 65536);
+static_assert(Ackermann(2, 5) == saturated);
+static_assert(Ackermann(3, 3) == 65536);
+static_assert(Ackermann(100, 2) == 4);
+static_assert(Ackermann(100, 3) == saturated);
+
+constexpr uint32_t S(uint32_t i, uint32_t j)
+{
+    if (i == 0)
+        throw std::out_of_range{"i must be > 0"};
+    return Ackermann(i - 1, j);
 }
 
-//static_assert(S(1, 1) == 2);
-//static_assert(S(3, 1) == 2);
+constexpr uint32_t Cube(uint32_t value)
+{
+    const uint64_t square = static_cast<uint64_t>(value) * value;
+    if (square > saturated || square * value > saturated)
+        return saturated;
+    return static_cast<uint32_t>(square * value);
+}
+
+constexpr uint32_t TargetSize(uint32_t t, uint32_t node_height)
+{
+    if (node_height == 1)
+        return Cube(S(t, 1));
+    return Cube(S(t - 1, S(t, node_height - 1)));
+}
+
+static_assert(S(1, 1) == 2);
+static_assert(S(3, 1) == 2);
+static_assert(TargetSize(2, 1) == 8);
+static_assert(TargetSize(2, 3) == 512);   // S(1, S(2, 2)) = 2 * 4
+static_assert(TargetSize(3, 2) == 64);    // S(2, S(3, 1)) = 2^2
+static_assert(TargetSize(3, 4) == saturated);
+} // namespace
 
 uint32_t FindMaxHeight(Graph::Graph& graph, uint32_t c)
 {
@@ -88,9 +133,10 @@ uint32_t FindParamT(const Graph::Graph& graph, uint32_t d)
 
     const double vertexes_count = static_cast<double>(graph.GetVerticesCount());
 
+    // Saturated size means that every graph fits
     uint32_t result = 1;
-    SPDLOG_DEBUG("std::pow(S(result, d), 3) {}", std::pow(S(result, d), 3));
-    while (vertexes_count > std::pow(S(result, d), 3))
+    SPDLOG_DEBUG("S(result, d)^3 {}", Cube(S(result, d)));
+    while (Cube(S(result, d)) != saturated && vertexes_count > Cube(S(result, d)))
         ++result;
 
     return result;
@@ -98,8 +144,6 @@ uint32_t FindParamT(const Graph::Graph& graph, uint32_t d)
 
 uint32_t CalculateTargetSize(uint32_t t, uint32_t node_height)
 {
-    if (node_height == 1)
-        return std::pow(S(t, 1u), 3u);
-    return std::pow(S(t - 1, S(t, node_height - 1)), 3u);
+    return TargetSize(t, node_height);
 }
 } // namespace MST
@@ -22,8 +22,12 @@
 
 #include "Graph.h"
 #include "MST.h"
+#include "MSTEngines.h"
+#include "MSTSoftHeapDecorator.h"
 
+#include <AllocTracker.h>
 #include <Common.h>
+#include <Generators.h>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
@@ -32,75 +36,15 @@
 #include <algorithm>
 #include <numeric>
 #include <random>
+#include <stdexcept>
 
+UTILS_DEFINE_ALLOCATION_TRACKING();
 
-static std::vector<std::tuple<size_t, size_t, size_t>> GenerateMatrix(uint32_t k, uint32_t postprocess_)
-{
-    std::vector<std::tuple<size_t, size_t, size_t>> edges{};
-    uint32_t                                   N = 1;
-    for (uint32_t i = 0; i < k; ++i)
-    {
-        auto size = edges.size();
-        for (size_t count = 0; count < size; ++count)
-        {
-            auto [i,j,w] = edges[count];
-            edges.emplace_back(i + N, j + N, 0);
-        }
-        edges.emplace_back(0, N, 0);
-        N *= 2;
-    }
-    for (uint32_t z = 0; z < postprocess_; ++z)
-    {
-        for (int count = edges.size() - 1; count >= 0; count--)
-        {
-            auto [i,j,w] = edges[count];
-            edges.emplace_back(i, N, 0);
-            edges.emplace_back(j, N, 0);
-            N += 1;
-        }
-    }
+using Utils::ErdosRenie;
+using Utils::GenerateMatrix;
 
-    std::vector<std::vector<uint32_t>> result{N};
-    for (size_t i = 0; i < N; ++i)
-        result[i].resize(N);
-
-    uint32_t weight = edges.size();
-    for (auto& edge : edges)
-    {
-       std::get<2>(edge) = weight--;
-    }
-    return edges;
-}
-
-static std::vector<std::tuple<size_t, size_t, size_t>> ErdosRenie(uint32_t n, double p)
-{
-    std::vector<size_t> values(n, 0);
-    std::iota(values.begin(), values.end(), 0);
-
-    std::vector<size_t> weights(std::pow(n,2), 0);
-    std::iota(weights.begin(), weights.end(), 1);
-
-    std::random_device rd;
-    std::mt19937       g(1);
-    std::ranges::shuffle(weights, g);
-
-    std::vector<std::tuple<size_t, size_t, size_t>> result{};
-    result.reserve(weights.size());
-    std::uniform_real_distribution<>                dis(0.0, 1.0);
-    for (size_t i = 0; i < n; ++i)
-    {
-        for (size_t j = i + 1; j < n; ++j)
-        {
-            if (dis(g) <= p)
-            {
-                result.emplace_back(i, j, weights.back());
-                weights.pop_back();
-            }
-        }
-    }
-
-    return result;
-}
+// Test graphs are small enough for Auto to skip soft heaps, so they are forced
+const MST::Options s_chazelle{.engine = MST::Engine::Chazelle};
 
 std::list<size_t> RunBoruvka(Graph::Graph&& g)
 {
@@ -111,7 +55,7 @@ std::list<size_t> RunBoruvka(Graph::Graph&& g)
 auto RunMST(Graph::Graph& g)
 {
     Utils::MeasurePerfomance measure{"SoftHeap MST"};
-    return MST::FindMST(g);
+    return MST::FindMST(g, 1, s_chazelle);
 }
 
 auto RunKruskal(const std::vector<std::tuple<size_t, size_t, size_t>>& edges, size_t v)
@@ -139,6 +83,84 @@ void CompareBoruvkaAndMst(std::list<size_t>& boruvka_result, std::list<size_t>&
     EXPECT_THAT(diff_in_mst, ::testing::SizeIs(0));
 }
 
+TEST(MST, Parallel)
+{
+    for (auto edges : {ErdosRenie(500, 0.02), GenerateMatrix(5, 2)})
+    {
+        Graph::Graph sequential_graph{edges};
+        Graph::Graph parallel_graph{edges};
+
+        auto sequential_result = MST::FindMST(sequential_graph, 1, s_chazelle);
+        auto parallel_result   = MST::FindMST(parallel_graph, 4, s_chazelle);
+
+        EXPECT_EQ(sequential_result, parallel_result);
+        CompareBoruvkaAndMst(sequential_result, parallel_result);
+    }
+}
+
+TEST(MST, EqualAndLargeWeights)
+{
+    auto equal_weights = ErdosRenie(500, 0.03);
+    for (auto& [i, j, w] : equal_weights)
+        w = w % 5 + 1;
+
+    auto large_weights = ErdosRenie(500, 0.03);
+    for (auto& [i, j, w] : large_weights)
+        w = (w << 34) + 1;
+
+    for (const auto& edges : {equal_weights, large_weights})
+    {
+        Graph::Graph g{edges};
+        auto         mst_result = MST::FindMST(g, 1, s_chazelle);
+
+        Kruskal::Graph kruskal{500, edges.size()};
+        size_t         index = 0;
+        for (const auto& [i, j, w] : edges)
+            kruskal.addEdge(i, j, w, index++);
+        const auto kruskal_result = kruskal.kruskalMST();
+
+        auto weight = [&](const std::list<size_t>& result)
+        {
+            return std::accumulate(result.begin(), result.end(), size_t{0}, [&](size_t sum, size_t index) { return sum + std::get<2>(edges[index]); });
+        };
+        EXPECT_EQ(mst_result.size(), kruskal_result.size());
+        EXPECT_EQ(weight(mst_result), weight(kruskal_result));
+    }
+}
+
+TEST(MST, IndexesAbove32Bits)
+{
+    auto edges = ErdosRenie(500, 0.03);
+    for (auto& [i, j, w] : edges)
+        w = w % 5 + 1;
+
+    // Low halves of all indexes are equal, so truncated keys of equal weights would collide
+    auto to_index = [](size_t index) { return (index + 1) << 32; };
+
+    Graph::Graph   g{};
+    Kruskal::Graph kruskal{500, edges.size()};
+    for (size_t index = 0; index < edges.size(); ++index)
+    {
+        const auto& [i, j, w] = edges[index];
+        g.AddEdge(i, j, w, to_index(index));
+        kruskal.addEdge(i, j, w, index);
+    }
+    const auto mst_result     = MST::FindMST(g, 1, s_chazelle);
+    const auto kruskal_result = kruskal.kruskalMST();
+
+    size_t mst_weight = 0;
+    for (const auto index : mst_result)
+    {
+        ASSERT_EQ(index % to_index(0), 0);
+        mst_weight += std::get<2>(edges[index / to_index(0) - 1]);
+    }
+    size_t kruskal_weight = 0;
+    for (const auto index : kruskal_result)
+        kruskal_weight += std::get<2>(edges[index]);
+    EXPECT_EQ(mst_result.size(), kruskal_result.size());
+    EXPECT_EQ(mst_weight, kruskal_weight);
+}
+
 //TEST(MST, TestGraph)
 //{
 //    //auto edges = GenerateMatrix(12, 1);
@@ -186,3 +208,353 @@ void CompareBoruvkaAndMst(std::list<size_t>& boruvka_result, std::list<size_t>&
 //
 //    std::cout << "Boruvka sum: " << boruvka << " Mst Sum: " << mst << " Boruvka == mst " << (boruvka == mst) << std::endl;*/
 //}
+
+TEST(MST, EnginesAgree)
+{
+    for (const auto& edges : {ErdosRenie(300, 0.02), ErdosRenie(60, 0.9), GenerateMatrix(5, 1)})
+    {
+        Graph::Graph reference_graph{edges};
+        auto         reference = reference_graph.BoruvkaPhase(100500);
+        for (auto engine : {MST::Engine::Auto, MST::Engine::Chazelle, MST::Engine::Boruvka, MST::Engine::Kruskal, MST::Engine::Prim})
+        {
+            Graph::Graph g{edges};
+            auto         result = MST::FindMST(g, 1, MST::Options{.engine = engine});
+            CompareBoruvkaAndMst(reference, result);
+        }
+    }
+}
+
+TEST(MST, EnginesOfContractedGraph)
+{
+    const auto edges    = ErdosRenie(200, 0.5);
+    auto       contract = [&]
+    {
+        Graph::Graph graph{edges};
+        for (size_t v = 1; v < 190; ++v)
+            graph.Union(0, v);
+        return graph;
+    };
+
+    auto       counted = contract();
+    const auto stale   = counted.GetTotalEdgesCount();
+    size_t     valid   = 0;
+    counted.ForValidEdges([&](const Graph::Details::Edge&, size_t, size_t) { ++valid; });
+    ASSERT_LT(valid, stale);
+
+    // Loops left by contraction are not counted
+    auto chosen = contract();
+    EXPECT_EQ(MST::ChooseEngine(chosen, MST::Options{.boruvka_max_edges = valid}), MST::Engine::Boruvka);
+
+    auto prim     = contract();
+    auto kruskal  = contract();
+    auto result   = MST::PrimMSF(prim);
+    auto expected = MST::KruskalMSF(kruskal);
+    result.sort();
+    expected.sort();
+    EXPECT_EQ(result, expected);
+    EXPECT_EQ(prim.GetVerticesCount(), 1);
+}
+
+TEST(MST, CustomOptions)
+{
+    const auto edges = ErdosRenie(500, 0.02);
+    for (const auto& options : {MST::Options{.engine = MST::Engine::Chazelle, .c = 2, .eps = 0.125},
+                                MST::Options{.engine = MST::Engine::Chazelle, .t = 2, .boruvka_rounds = 1},
+                                MST::Options{.c = 8, .boruvka_max_edges = 1024}})
+    {
+        Graph::Graph reference_graph{edges};
+        Graph::Graph g{edges};
+        auto         reference = reference_graph.BoruvkaPhase(100500);
+        auto         result    = MST::FindMST(g, 1, options);
+        CompareBoruvkaAndMst(reference, result);
+    }
+
+    Graph::Graph g{edges};
+    EXPECT_THROW(MST::FindMST(g, 1, MST::Options{.c = 0}), std::invalid_argument);
+    EXPECT_THROW(MST::FindMST(g, 1, MST::Options{.c = 1}), std::invalid_argument);
+    EXPECT_THROW(MST::FindMST(g, 1, MST::Options{.eps = 1}), std::invalid_argument);
+}
+
+TEST(MST, Stats)
+{
+    const auto edges = ErdosRenie(5000, 0.002);
+
+    Graph::Graph plain_graph{edges};
+    Graph::Graph sequential_graph{edges};
+    Graph::Graph parallel_graph{edges};
+    MST::Stats   sequential{};
+    MST::Stats   parallel{};
+
+    const auto plain_result      = MST::FindMST(plain_graph, 1, s_chazelle);
+    const auto sequential_result = MST::FindMST(sequential_graph, 1, s_chazelle, &sequential);
+    const auto parallel_result   = MST::FindMST(parallel_graph, 4, s_chazelle, &parallel);
+    EXPECT_EQ(plain_result, sequential_result);
+    EXPECT_EQ(plain_result, parallel_result);
+
+    EXPECT_GT(sequential.t, 1);
+    EXPECT_GE(sequential.recursion_depth, 2);
+    EXPECT_GT(sequential.tree_builds, 0);
+    EXPECT_GT(sequential.extensions, 0);
+    EXPECT_GE(sequential.heap_inserts, sequential.heap_deletes);
+    EXPECT_GT(sequential.heap_deletes, 0);
+    EXPECT_GT(sequential.total_seconds, 0);
+    // Subgraphs contract edges which may be left out of the final forest
+    EXPECT_GT(sequential.boruvka_contractions.front(), 0);
+    EXPECT_GE(std::accumulate(sequential.boruvka_contractions.begin(), sequential.boruvka_contractions.end(), size_t{0}),
+              plain_result.size());
+
+    EXPECT_EQ(std::accumulate(sequential.heap_raises_per_rank.begin(), sequential.heap_raises_per_rank.end(), size_t{0}),
+              sequential.heap_ckey_raises);
+    EXPECT_GE(sequential.heap_corrupted, sequential.bad_edges);
+    EXPECT_GT(sequential.r_per_level.front(), 0);
+
+    // Recursion is the same for any number of threads, only timings differ
+    EXPECT_EQ(sequential.recursion_depth, parallel.recursion_depth);
+    EXPECT_EQ(sequential.tree_builds, parallel.tree_builds);
+    EXPECT_EQ(sequential.extensions, parallel.extensions);
+    EXPECT_EQ(sequential.retractions, parallel.retractions);
+    EXPECT_EQ(sequential.fusions, parallel.fusions);
+    EXPECT_EQ(sequential.bad_edges, parallel.bad_edges);
+    EXPECT_EQ(sequential.heap_inserts, parallel.heap_inserts);
+    EXPECT_EQ(sequential.heap_deletes, parallel.heap_deletes);
+    EXPECT_EQ(sequential.boruvka_contractions, parallel.boruvka_contractions);
+    EXPECT_EQ(sequential.heap_corrupted, parallel.heap_corrupted);
+    EXPECT_EQ(sequential.r_per_level, parallel.r_per_level);
+}
+
+TEST(MST, AdaptiveR)
+{
+    const auto edges = ErdosRenie(5000, 0.002);
+    for (double eps : {0.0, 0.5, 0.01})
+    {
+        Graph::Graph reference_graph{edges};
+        Graph::Graph g{edges};
+        MST::Stats   stats{};
+        auto         reference = reference_graph.BoruvkaPhase(100500);
+        auto         result    = MST::FindMST(g, 1, MST::Options{.engine = MST::Engine::Chazelle, .eps = eps, .adaptive_r = true}, &stats);
+        CompareBoruvkaAndMst(reference, result);
+        EXPECT_TRUE(std::ranges::all_of(stats.r_per_level, [](size_t r) { return r <= 64; }));
+    }
+}
+
+TEST(Profiler, MSTPhasesBudgets)
+{
+#ifndef PROFILING_ENABLED
+    GTEST_SKIP() << "Profiler scopes are compiled in only with PROFILING_ENABLE";
+#endif
+    Graph::Graph graph{ErdosRenie(5000, 0.002)};
+    Utils::Profiler::Reset();
+    Utils::Profiler::Enable(true);
+    MST::FindMST(graph, 1, s_chazelle);
+    Utils::Profiler::Disable();
+
+    const auto report = Utils::Profiler::GetReport();
+    for (const auto* name : {"BoruvkaPhase", "MSTTreeBuilder"})
+    {
+        const auto stats = report.Total(name);
+        EXPECT_GT(stats.calls, 0) << name;
+        EXPECT_LE(stats.nanoseconds, report.Total("MSF").nanoseconds) << name;
+        // Hardware counters are not available in containers and virtual machines without PMU
+        if (stats.has_counters)
+        {
+            EXPECT_GT(stats.GetIpc(), 0.1) << name;
+            EXPECT_LT(stats.GetLlcMpki(), 100.0) << name;
+            EXPECT_LT(stats.GetBranchMpki(), 100.0) << name;
+        }
+    }
+    Utils::Profiler::Reset();
+}
+
+TEST(Alloc, AccountsComponentsAndLevels)
+{
+    ASSERT_TRUE(Utils::Alloc::IsInstalled());
+    Graph::Graph graph{ErdosRenie(5000, 0.002)};
+    const auto   soft_heap_before = Utils::Alloc::GetReport().Get(Utils::Alloc::Component::SoftHeap);
+
+    Utils::Alloc::Reset();
+    const auto result = MST::FindMST(graph, 1, s_chazelle);
+    const auto report = Utils::Alloc::GetReport();
+
+    for (auto component : {Utils::Alloc::Component::Graph, Utils::Alloc::Component::MSTTree, Utils::Alloc::Component::SoftHeap})
+    {
+        const auto& stats = report.Get(component);
+        EXPECT_GT(stats.allocations, 0);
+        EXPECT_GE(stats.bytes, stats.allocations);
+        EXPECT_LE(stats.peak_bytes, report.GetTotal().peak_bytes);
+    }
+    EXPECT_GT(report.Get(Utils::Alloc::Component::MSTTree, 1).allocations, 0);
+    EXPECT_GE(report.GetMaxLevel(), 2);
+
+    // Soft heaps are released with their trees
+    EXPECT_EQ(report.Get(Utils::Alloc::Component::SoftHeap).live_bytes, soft_heap_before.live_bytes);
+}
+
+TEST(Alloc, SoftHeapSteadyStateDoesNotAllocate)
+{
+    std::vector<Graph::Details::Edge> edges{};
+    for (size_t i = 0; i < 1000; ++i)
+        edges.push_back(Graph::Details::Edge{0, i + 1, (i * 7919) % 1000, i});
+
+    // Ranks of 1000 items stay below r, so nothing is corrupted and bad edges don't grow
+    std::set<size_t>                       bad_edges{};
+    std::pmr::unsynchronized_pool_resource memory{};
+    MST::Details::EdgeItemPool             items{};
+    MST::Details::MSTSoftHeapDecorator     heap{Utils::CalculateRByEps(1.0 / 1024), bad_edges, 0, &memory, items};
+
+    auto round = [&]
+    {
+        for (const auto& edge : edges)
+            heap.Insert(MST::Details::EdgePtrWrapper{&edge, edge.j});
+        while (heap.FindMin())
+            heap.DeleteMin();
+    };
+
+    // First round fills the pool, later ones only recycle its blocks
+    round();
+    const auto before = Utils::Alloc::GetThreadAllocations();
+    round();
+    round();
+    EXPECT_EQ(Utils::Alloc::GetThreadAllocations(), before);
+    EXPECT_TRUE(bad_edges.empty());
+}
+
+TEST(MSTSoftHeapDecorator, CorruptionIsReportedOncePerEdge)
+{
+    for (size_t weights_count : {size_t{1}, size_t{1000}})
+    {
+        std::vector<Graph::Details::Edge> edges{};
+        for (size_t i = 0; i < 1000; ++i)
+            edges.push_back(Graph::Details::Edge{0, i + 1, (i * 7919) % weights_count, i});
+
+        SoftHeapCounters                   counters{};
+        std::set<size_t>                   bad_edges{};
+        MST::Details::EdgeItemPool         items{};
+        MST::Details::MSTSoftHeapDecorator heap{0, bad_edges, 0, std::pmr::get_default_resource(), items, &counters};
+        for (const auto& edge : edges)
+            heap.Insert(MST::Details::EdgePtrWrapper{&edge, edge.j});
+        while (heap.FindMin())
+            heap.DeleteMin();
+
+        // Equal costs are ordered by index, raise to ckey of the same cost doesn't corrupt an edge
+        EXPECT_EQ(counters.corrupted, bad_edges.size()) << weights_count;
+        if (weights_count == 1)
+            EXPECT_EQ(counters.corrupted, 0);
+        else
+            EXPECT_GT(counters.corrupted, 0);
+    }
+}
+
+TEST(MSTSoftHeapDecorator, DeletedItemsAreSkipped)
+{
+    std::vector<Graph::Details::Edge> edges{};
+    for (size_t i = 0; i < 1000; ++i)
+        edges.push_back(Graph::Details::Edge{0, i + 1, 1000 - i, i});
+
+    std::set<size_t>                   bad_edges{};
+    MST::Details::EdgeItemPool         items{};
+    MST::Details::MSTSoftHeapDecorator heap{Utils::CalculateRByEps(1.0 / 8), bad_edges, 0, std::pmr::get_default_resource(), items};
+    for (const auto& edge : edges)
+        heap.Insert(MST::Details::EdgePtrWrapper{&edge, edge.j});
+
+    const auto deleted = heap.DeleteAndReturnIf([](const MST::Details::EdgePtrWrapper& edge) { return edge->index % 2 == 0; });
+    EXPECT_EQ(deleted.size(), 500);
+    EXPECT_EQ(heap.GetSize(), 500);
+
+    std::set<size_t> popped{};
+    while (heap.FindMin())
+        popped.insert(heap.DeleteMin()->index);
+
+    EXPECT_EQ(popped.size(), 500);
+    EXPECT_TRUE(std::ranges::all_of(popped, [](size_t index) { return index % 2 == 1; }));
+    EXPECT_EQ(heap.GetSize(), 0);
+}
+
+TEST(MSTSoftHeapDecorator, DeleteByOutsideVertex)
+{
+    std::vector<Graph::Details::Edge> edges{};
+    for (size_t i = 0; i < 100; ++i)
+        edges.push_back(Graph::Details::Edge{0, i % 10 + 1, 100 - i, i});
+
+    std::set<size_t>                   bad_edges{};
+    const auto                         r = Utils::CalculateRByEps(1.0 / 8);
+    MST::Details::EdgeItemPool         items{};
+    MST::Details::MSTSoftHeapDecorator heap{r, bad_edges, 0, std::pmr::get_default_resource(), items};
+    MST::Details::MSTSoftHeapDecorator other{r, bad_edges, 0, std::pmr::get_default_resource(), items};
+    for (const auto& edge : edges)
+        (edge.index < 50 ? heap : other).Insert(MST::Details::EdgePtrWrapper{&edge, edge.j});
+
+    // Items of the same vertex from both heaps are joined by meld
+    heap.Meld(other);
+    EXPECT_EQ(other.GetSize(), 0);
+    EXPECT_TRUE(other.DeleteAndReturnByOutsideVertex(3).empty());
+
+    const auto deleted = heap.DeleteAndReturnByOutsideVertex(3);
+    EXPECT_EQ(deleted.size(), 10);
+    EXPECT_TRUE(std::ranges::all_of(deleted, [](const MST::Details::EdgePtrWrapper& edge) { return edge.GetOutsideVertex() == 3; }));
+    EXPECT_TRUE(heap.DeleteAndReturnByOutsideVertex(3).empty());
+    EXPECT_EQ(heap.GetSize(), 90);
+
+    std::set<size_t> popped{};
+    while (heap.FindMin())
+        popped.insert(heap.DeleteMin().GetOutsideVertex());
+
+    EXPECT_EQ(popped.size(), 9);
+    EXPECT_FALSE(popped.contains(3));
+}
+
+TEST(MSTSoftHeapDecorator, DeleteByOutsideVertexRaisesCostsAsFlush)
+{
+    std::vector<Graph::Details::Edge> edges{};
+    for (size_t i = 0; i < 1000; ++i)
+        edges.push_back(Graph::Details::Edge{0, i % 10 + 1, (i * 7919) % 1000, i});
+
+    std::set<size_t>                   bad_edges{};
+    MST::Details::EdgeItemPool         items{};
+    MST::Details::MSTSoftHeapDecorator by_vertex{0, bad_edges, 0, std::pmr::get_default_resource(), items};
+    MST::Details::MSTSoftHeapDecorator flushed{0, bad_edges, 1, std::pmr::get_default_resource(), items};
+    for (const auto& edge : edges)
+    {
+        by_vertex.Insert(MST::Details::EdgePtrWrapper{&edge, edge.j});
+        flushed.Insert(MST::Details::EdgePtrWrapper{&edge, edge.j});
+    }
+    for (size_t i = 0; i < 100; ++i)
+    {
+        by_vertex.DeleteMin();
+        flushed.DeleteMin();
+    }
+    EXPECT_FALSE(bad_edges.empty());
+
+    // Only edges of the vertex get raised costs, but the same as after flush of the whole heap
+    for (size_t vertex = 1; vertex <= 10; ++vertex)
+    {
+        auto lhs = by_vertex.DeleteAndReturnByOutsideVertex(vertex);
+        auto rhs = flushed.DeleteAndReturnIf([&](const MST::Details::EdgePtrWrapper& edge) { return edge.GetOutsideVertex() == vertex; });
+        const auto by_index = [](const auto& l, const auto& r) { return l->index < r->index; };
+        lhs.sort(by_index);
+        rhs.sort(by_index);
+        ASSERT_EQ(lhs.size(), rhs.size());
+        EXPECT_TRUE(std::ranges::equal(lhs, rhs, {}, &MST::Details::EdgePtrWrapper::GetKey, &MST::Details::EdgePtrWrapper::GetKey));
+    }
+}
+
+TEST(MSTSoftHeapDecorator, ExtractedItemsAreSortedByKey)
+{
+    std::vector<Graph::Details::Edge> edges{};
+    for (size_t i = 0; i < 1000; ++i)
+        edges.push_back(Graph::Details::Edge{0, (i * 31) % 97 + 1, (i * 7919) % 1000 + 1, i});
+
+    std::set<size_t>                   bad_edges{};
+    MST::Details::EdgeItemPool         items{};
+    MST::Details::MSTSoftHeapDecorator heap{Utils::CalculateRByEps(1.0 / 8), bad_edges, 0, std::pmr::get_default_resource(), items};
+    for (const auto& edge : edges)
+        heap.Insert(MST::Details::EdgePtrWrapper{&edge, edge.j});
+    for (size_t i = 0; i < 100; ++i)
+        heap.DeleteMin();
+
+    // Order of output doesn't depend on hashing of outside vertices
+    const auto extracted = heap.ExtractItems();
+    EXPECT_EQ(extracted.corrupted.size() + extracted.items.size(), 900);
+    EXPECT_TRUE(std::ranges::is_sorted(extracted.corrupted, {}, &MST::Details::EdgePtrWrapper::GetKey));
+    EXPECT_TRUE(std::ranges::is_sorted(extracted.items, {}, &MST::Details::EdgePtrWrapper::GetKey));
+    EXPECT_EQ(heap.GetSize(), 0);
+}
@@ -0,0 +1,299 @@
+// MIT License
+// 
+// Copyright (c) 2021 Aleksey Loginov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Performance regression checks of hot paths against PerfBaseline.txt, registered in ctest with label PerfTest.
+// Allocation counts are checked always. Wall time is the best of several runs divided by the best time of a reference
+// sort measured in the same process, so baseline doesn't depend on speed of the machine. Time is checked only with
+// MST_PERF_CHECK_TIME=1 in optimized builds, ctest sets it for MSTPerfTimeTest which is enabled by PERF_TIME_CHECKS.
+// MST_PERF_TOLERANCE sets allowed regression in percent (50 by default), MST_PERF_UPDATE_BASELINE=1 rewrites the
+// baseline with measured values instead of checking them.
+
+#include "Graph.h"
+#include "MST.h"
+
+#include <AllocTracker.h>
+#include <Common.h>
+#include <Generators.h>
+#include <Kruskal.h>
+#include <SoftHeapCpp.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+UTILS_DEFINE_ALLOCATION_TRACKING();
+
+namespace
+{
+constexpr size_t s_repeats = 5;
+
+struct Measurement
+{
+    double relative_time; // wall time in units of the reference sort
+    size_t allocations;
+};
+
+bool IsEnvSet(const char* name)
+{
+    const auto* value = std::getenv(name);
+    return value && std::string{value} == "1";
+}
+
+bool IsUpdateMode() { return IsEnvSet("MST_PERF_UPDATE_BASELINE"); }
+
+bool IsTimeChecked()
+{
+#ifdef NDEBUG
+    return IsEnvSet("MST_PERF_CHECK_TIME");
+#else
+    return false;
+#endif
+}
+
+template<typename Func>
+double BestSeconds(Func&& func)
+{
+    double best = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < s_repeats; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+// Sort of fixed random keys, measured once per process
+double GetReferenceSeconds()
+{
+    static const double s_seconds = []
+    {
+        std::mt19937_64       g{1};
+        std::vector<uint64_t> keys(1 << 20);
+        for (auto& key : keys)
+            key = g();
+
+        return BestSeconds([&]
+        {
+            auto copy = keys;
+            std::sort(copy.begin(), copy.end());
+        });
+    }();
+    return s_seconds;
+}
+
+double GetTolerance()
+{
+    const auto* value = std::getenv("MST_PERF_TOLERANCE");
+    return value ? std::stod(value) : 50.0;
+}
+
+// Lines of "name relative_time allocations", lines starting with '#' are comments
+class Baseline
+{
+public:
+    static Baseline& Instance()
+    {
+        static Baseline s_baseline{MST_PERF_BASELINE};
+        return s_baseline;
+    }
+
+    std::optional<Measurement> Find(const std::string& name) const
+    {
+        const auto itr = m_entries.find(name);
+        return itr == m_entries.end() ? std::nullopt : std::optional{itr->second};
+    }
+
+    void Update(const std::string& name, const Measurement& measurement) { m_entries[name] = measurement; }
+
+    void Save() const
+    {
+        std::ofstream out{m_path};
+        out << "# name relative_time allocations\n";
+        out << "# relative_time is wall time divided by time of the reference sort\n";
+        out << "# Recorded by MSTPerfTest with MST_PERF_UPDATE_BASELINE=1 in Release build\n";
+        for (const auto& [name, measurement] : m_entries)
+            out << name << " " << std::setprecision(6) << measurement.relative_time << " " << measurement.allocations << "\n";
+    }
+
+private:
+    explicit Baseline(std::string path)
+        : m_path{std::move(path)}
+    {
+        std::ifstream in{m_path};
+        std::string   line{};
+        while (std::getline(in, line))
+        {
+            if (line.empty() || line.front() == '#')
+                continue;
+
+            std::istringstream stream{line};
+            std::string        name{};
+            Measurement        measurement{};
+            if (stream >> name >> measurement.relative_time >> measurement.allocations)
+                m_entries[name] = measurement;
+        }
+    }
+
+    const std::string                  m_path;
+    std::map<std::string, Measurement> m_entries{};
+};
+
+class BaselineEnvironment : public ::testing::Environment
+{
+public:
+    void TearDown() override
+    {
+        if (IsUpdateMode())
+            Baseline::Instance().Save();
+    }
+};
+
+const auto* const s_environment = ::testing::AddGlobalTestEnvironment(new BaselineEnvironment{});
+
+// Input is prepared outside of measurement, allocation count is the same for every run of a deterministic workload
+template<typename Prepare, typename Run>
+Measurement Measure(Prepare&& prepare, Run&& run)
+{
+    double best_seconds = std::numeric_limits<double>::max();
+    size_t allocations  = 0;
+    for (size_t i = 0; i < s_repeats; ++i)
+    {
+        auto       input              = prepare();
+        const auto allocations_before = Utils::Alloc::GetThreadAllocations();
+        const auto start              = std::chrono::steady_clock::now();
+        run(input);
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        best_seconds = std::min(best_seconds, seconds);
+        allocations  = Utils::Alloc::GetThreadAllocations() - allocations_before;
+    }
+    return Measurement{best_seconds / GetReferenceSeconds(), allocations};
+}
+
+void Check(const std::string& name, const Measurement& measurement)
+{
+    ::testing::Test::RecordProperty("relative_time", std::to_string(measurement.relative_time));
+    ::testing::Test::RecordProperty("allocations", std::to_string(measurement.allocations));
+    if (IsUpdateMode())
+    {
+        Baseline::Instance().Update(name, measurement);
+        return;
+    }
+
+    const auto baseline = Baseline::Instance().Find(name);
+    ASSERT_TRUE(baseline) << "No baseline for " << name << ", record it with MST_PERF_UPDATE_BASELINE=1";
+
+    const auto limit = 1.0 + GetTolerance() / 100.0;
+    std::cout << name << ": relative time " << measurement.relative_time << " (baseline " << baseline->relative_time << "), "
+              << measurement.allocations << " allocations (baseline " << baseline->allocations << ")" << std::endl;
+
+    EXPECT_LE(static_cast<double>(measurement.allocations), static_cast<double>(baseline->allocations) * limit) << name;
+    if (IsTimeChecked())
+    {
+        EXPECT_LE(measurement.relative_time, baseline->relative_time * limit) << name;
+    }
+}
+} // namespace
+
+TEST(PerfTest, FindMSTChazelle)
+{
+    const auto edges = Utils::ErdosRenie(20000, 0.0005, 1);
+    Check("find_mst_chazelle",
+          Measure([&] { return Graph::Graph{edges}; },
+                  [](Graph::Graph& graph) { MST::FindMST(graph, 1, MST::Options{.engine = MST::Engine::Chazelle}); }));
+}
+
+TEST(PerfTest, FindMSTTrees)
+{
+    // Default parameters contract such graphs mostly by Boruvka, these ones keep soft heaps and recursion busy
+    const auto edges = Utils::ErdosRenie(5000, 0.002, 1);
+    Check("find_mst_trees",
+          Measure([&] { return Graph::Graph{edges}; },
+                  [](Graph::Graph& graph) { MST::FindMST(graph, 1, MST::Options{.engine = MST::Engine::Chazelle, .t = 3, .boruvka_rounds = 1}); }));
+}
+
+TEST(PerfTest, FindMSTAuto)
+{
+    const auto edges = Utils::GenerateMatrix(15, 1);
+    Check("find_mst_auto",
+          Measure([&] { return Graph::Graph{edges}; },
+                  [](Graph::Graph& graph) { MST::FindMST(graph); }));
+}
+
+TEST(PerfTest, BoruvkaPhase)
+{
+    const auto edges = Utils::ErdosRenie(20000, 0.0005, 1);
+    Check("boruvka_phase",
+          Measure([&] { return Graph::Graph{edges}; },
+                  [](Graph::Graph& graph) { graph.BoruvkaPhase(std::numeric_limits<uint32_t>::max()); }));
+}
+
+TEST(PerfTest, KruskalMST)
+{
+    const auto edges = Utils::ErdosRenie(20000, 0.0005, 1);
+    Check("kruskal_mst",
+          Measure([&]
+                  {
+                      Kruskal::Graph graph{20000, edges.size()};
+                      size_t         index = 0;
+                      for (const auto& [i, j, w] : edges)
+                          graph.addEdge(i, j, w, index++);
+                      return graph;
+                  },
+                  [](Kruskal::Graph& graph) { graph.kruskalMST(); }));
+}
+
+TEST(PerfTest, SoftHeapCppMix)
+{
+    // Two inserts per delete-min, keys and order of operations are fixed by the seed
+    Check("soft_heap_cpp_mix",
+          Measure([] { return std::mt19937{1}; },
+                  [](std::mt19937& g)
+                  {
+                      SoftHeapCpp<uint64_t> heap(Utils::CalculateRByEps(1.0 / 8));
+                      size_t                size = 0;
+                      for (size_t i = 0; i < 300000; ++i)
+                      {
+                          if (size && g() % 3 == 0)
+                          {
+                              heap.DeleteMin();
+                              --size;
+                          }
+                          else
+                          {
+                              heap.Insert(g());
+                              ++size;
+                          }
+                      }
+                  }));
+}
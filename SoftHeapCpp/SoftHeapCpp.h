@@ -29,37 +29,222 @@
 #include <algorithm>
 #include <cassert>
 #include <functional>
+#include <limits>
 #include <list>
 #include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Receives events of a soft heap synchronously from the operation which causes them. One observer may watch several
+// heaps of one thread
+class SoftHeapObserver
+{
+public:
+    virtual ~SoftHeapObserver() = default;
+
+    virtual void OnInsert() {}
+    // Sift concatenated item list of node of rank with list of its child: ckey of list_size items is raised
+    virtual void OnCkeyRaised(size_t /*rank*/, size_t /*list_size*/) {}
+    // on_key_raised reported that raise of ckey corrupted the item. Without on_key_raised an item is reported whenever
+    // it is returned with ckey above its key, so the same item may be reported again
+    virtual void OnCorrupted() {}
+};
 
-struct Head;
-struct Node;
+// Observer which only counts events
+class SoftHeapCounters : public SoftHeapObserver
+{
+public:
+    void OnInsert() override { ++inserts; }
+    void OnCkeyRaised(size_t rank, size_t list_size) override
+    {
+        ++ckey_raises;
+        max_list_size = std::max(max_list_size, list_size);
+        if (raises_per_rank.size() <= rank)
+            raises_per_rank.resize(rank + 1);
+        ++raises_per_rank[rank];
+    }
+    void OnCorrupted() override { ++corrupted; }
 
-template<typename ItemType>
+    size_t              inserts{};
+    size_t              ckey_raises{};
+    size_t              corrupted{};
+    size_t              max_list_size{};
+    std::vector<size_t> raises_per_rank{};
+};
+
+// Allocator is used for nodes, heads, shared ckeys and value lists, so pool allocators (for example
+// std::pmr::polymorphic_allocator over std::pmr::unsynchronized_pool_resource) recycle memory between heaps
+template<typename ItemType, typename Allocator = std::allocator<ItemType>>
 class SoftHeapCpp
 {
 public:
-    SoftHeapCpp(size_t r, std::function<void(ItemType& item, const ItemType& ckey)> on_key_raised = {});
-    virtual ~SoftHeapCpp() = default;
-
-    virtual void     Insert(ItemType new_key);
+    using allocator_type = Allocator;
+
+    struct ListCkey;
+    // Refers to the list which item was inserted into, allows to find the current ckey of the item without a walk
+    using ListRef = std::shared_ptr<ListCkey>;
+
+    // on_key_raised is called for item with key below ckey of its node and returns true if item becomes corrupted by it
+    SoftHeapCpp(size_t                                                     r,
+                std::function<bool(ItemType& item, const ItemType& ckey)> on_key_raised = {},
+                const Allocator&                                           allocator     = Allocator{});
+    SoftHeapCpp(SoftHeapCpp&& other) noexcept;
+    SoftHeapCpp(const SoftHeapCpp& other)            = delete;
+    SoftHeapCpp& operator=(const SoftHeapCpp& other) = delete;
+    SoftHeapCpp& operator=(SoftHeapCpp&& other)      = delete;
+    virtual ~SoftHeapCpp();
+
+    // Returns empty ref when the heap has no on_key_raised
+    virtual ListRef  Insert(ItemType new_key);
     virtual ItemType DeleteMin();
 
+    // Moves all items from other, other becomes empty
     void           Meld(SoftHeapCpp& other);
 
+    // Sift concatenates item lists in O(1) and postpones on_key_raised: FindMin/DeleteMin apply it to the returned
+    // item only, Flush applies it to every item which is still in the heap
+    void           Flush();
+    // Applies postponed on_key_raised to one item inserted with list. Item may be a copy of the stored one
+    void           Flush(ItemType& item, const ListRef& list);
+
+    // Observer must outlive the heap or be reset by nullptr. Without observer events cost nothing
+    void SetObserver(SoftHeapObserver* observer) { m_observer = observer; }
+
     virtual ItemType* FindMin();
 private:
+    template<typename T>
+    using Rebind = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+    template<typename T>
+    struct Deleter
+    {
+        Deleter() = default;
+        Deleter(const Rebind<T>& alloc)
+            : allocator{alloc} {}
+        Deleter(const Deleter& other) = default;
+
+        // Nodes are moved between heaps during meld, but polymorphic_allocator is not assignable
+        Deleter& operator=(const Deleter& other)
+        {
+            std::destroy_at(&allocator);
+            std::construct_at(&allocator, other.allocator);
+            return *this;
+        }
+
+        void operator()(T* ptr)
+        {
+            std::destroy_at(ptr);
+            std::allocator_traits<Rebind<T>>::deallocate(allocator, ptr, 1);
+        }
+
+        Rebind<T> allocator{};
+    };
+
+    template<typename T>
+    using Ptr = std::unique_ptr<T, Deleter<T>>;
+
+    // Only memory comes from allocator: construction through allocator_traits would pass pmr allocators into ItemType
+    template<typename T, typename... Args>
+    static Ptr<T> Create(const Allocator& allocator, Args&&... args)
+    {
+        Deleter<T> deleter{Rebind<T>{allocator}};
+        T*         ptr = std::allocator_traits<Rebind<T>>::allocate(deleter.allocator, 1);
+        try
+        {
+            std::construct_at(ptr, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            std::allocator_traits<Rebind<T>>::deallocate(deleter.allocator, ptr, 1);
+            throw;
+        }
+        return Ptr<T>{ptr, std::move(deleter)};
+    }
+
+    using Values = std::list<ItemType, Rebind<ItemType>>;
+
+    // Trivially copyable items (for example packed integer keys) are stored inline as ckeys, others are shared between
+    // nodes to avoid copies
+    static constexpr bool is_inline_ckey = std::is_trivially_copyable_v<ItemType>;
+    using Ckey = std::conditional_t<is_inline_ckey, std::optional<ItemType>, std::shared_ptr<ItemType>>;
+
+    static Ckey MakeCkey(const ItemType& item, const Allocator& allocator)
+    {
+        if constexpr (is_inline_ckey)
+            return item;
+        else
+            return std::allocate_shared<ItemType>(Rebind<ItemType>{allocator}, item);
+    }
+
+public:
+    // Ckey of items of one list. Cell of a list spliced into another one links to the cell of that list, so the current
+    // ckey of an item is in the last cell of the chain
+    struct ListCkey
+    {
+        Ckey    ckey{};
+        ListRef merged_into{};
+    };
+
+private:
+    // Lists of untracked heaps have no cell. List of inserted item keeps its first cell inline, so insert allocates
+    // nothing for it. Refs to the inline cell share ownership of the whole list, the list itself never refers to it
+    struct ValueList
+    {
+        ValueList(const Allocator& allocator, bool has_cell, const Ckey& ckey)
+            : values{Rebind<ItemType>{allocator}}
+            , inline_cell{has_cell ? ckey : Ckey{}}
+            , is_inline_cell{has_cell} {}
+
+        bool HasCell() const { return is_inline_cell || !!extra_cell; }
+        ListCkey& GetCell() { return is_inline_cell ? inline_cell : *extra_cell; }
+
+        Values   values;
+        ListCkey inline_cell;
+        bool     is_inline_cell;
+        ListRef  extra_cell{};
+    };
+
+    static ListRef GetCellRef(const std::shared_ptr<ValueList>& list)
+    {
+        return list->is_inline_cell ? ListRef{list, &list->inline_cell} : list->extra_cell;
+    }
+
+    // Items of from were moved into to, cell of from links to cell of to. A list emptied by splice may be reused by
+    // sift, it gets a new cell then
+    static void LinkCkeys(const std::shared_ptr<ValueList>& to, const std::shared_ptr<ValueList>& from, const Ckey& ckey)
+    {
+        auto from_cell = GetCellRef(from);
+        from->is_inline_cell = false;
+        from->extra_cell.reset();
+
+        if (from_cell && !to->HasCell())
+            to->extra_cell = std::allocate_shared<ListCkey>(Rebind<ListCkey>{to->values.get_allocator()});
+        if (!to->HasCell())
+            return;
+        if (from_cell)
+            from_cell->merged_into = GetCellRef(to);
+        // Nodes sharing a list may have different ckeys, items of the list get the largest one
+        auto& cell = to->GetCell();
+        if (!cell.ckey || *cell.ckey < *ckey)
+            cell.ckey = ckey;
+    }
+
     struct Node
     {
-        Node(ItemType item)
-            : m_ckey{std::make_shared<ItemType>(item)}
+        Node(ItemType item, const Allocator& allocator, bool has_cell)
+            : m_ckey{MakeCkey(item, allocator)}
             , m_rank{0}
+            , m_values{std::allocate_shared<ValueList>(Rebind<ValueList>{allocator}, allocator, has_cell, m_ckey)}
         {
-            m_values = std::make_shared<std::list<ItemType>>();
-            m_values->push_front(std::move(item));
+            m_values->values.push_front(std::move(item));
         }
 
-        Node(std::unique_ptr<Node> top, std::unique_ptr<Node> bottom)
+        // Empty ref if the list has no cell
+        ListRef GetListRef() const { return GetCellRef(m_values); }
+
+        Node(Ptr<Node> top, Ptr<Node> bottom)
             : m_ckey{top->m_ckey}
             , m_rank{top->m_rank + 1}
             , m_next{std::move(top)}
@@ -67,14 +252,23 @@ private:
             , m_values{m_next->m_values} { }
 
         size_t                                          GetRank() const { return m_rank; }
-        [[nodiscard]] Utils::ComparableObject<ItemType> GetCkey() const { return {m_ckey.get()}; }
+        [[nodiscard]] Utils::ComparableObject<ItemType> GetCkey() const { return {m_ckey ? &*m_ckey : nullptr}; }
         bool                                            IsInfntyCkey() const { return !m_ckey; }
-        [[nodiscard]] std::unique_ptr<Node>             ExtractChild() { return std::move(m_child); }
+        [[nodiscard]] Ptr<Node>                         ExtractChild() { return std::move(m_child); }
+        bool IsNoValues() const { return !m_values || m_values->values.empty(); }
 
+        // Returns count of concatenated lists, items of these lists may be not raised to ckey yet
+        size_t Sift(size_t r, SoftHeapObserver* observer);
 
-        bool IsNoValues() const { return !m_values || m_values->empty(); }
-
-        void Sift(size_t r, const std::function<void(ItemType& item, const ItemType& ckey)>& action);
+        void ForEachValues(const std::function<void(Values& values, const ItemType& ckey)>& func)
+        {
+            if (m_ckey && m_values && !m_values->values.empty())
+                func(m_values->values, *m_ckey);
+            if (m_next)
+                m_next->ForEachValues(func);
+            if (m_child)
+                m_child->ForEachValues(func);
+        }
 
         void ForEachNodeWithChildOnLevel(std::function<void(Node* node)> func)
         {
@@ -85,20 +279,25 @@ private:
             }
         }
 
-        ItemType& FrontValue()
+        ItemType& FrontValue(const std::function<bool(ItemType& item, const ItemType& ckey)>& action, SoftHeapObserver* observer)
         {
-            assert(!!m_values && !m_values->empty());
-            return m_values->front();
+            assert(!!m_values && !m_values->values.empty());
+            auto& value = m_values->values.front();
+            if ((action || observer) && value < *m_ckey)
+            {
+                const bool corrupted = action ? action(value, *m_ckey) : true;
+                if (observer && corrupted)
+                    observer->OnCorrupted();
+            }
+            return value;
         }
 
-        ItemType PopValue()
+        ItemType PopValue(const std::function<bool(ItemType& item, const ItemType& ckey)>& action, SoftHeapObserver* observer)
         {
-            assert(!!m_values && !m_values->empty());
-
             //PrintData();
 
-            auto value = std::move(m_values->front());
-            m_values->pop_front();
+            auto value = std::move(FrontValue(action, observer));
+            m_values->values.pop_front();
 
             return value;
         }
@@ -141,52 +340,62 @@ private:
         //}
 
     private:
-        std::shared_ptr<ItemType>             m_ckey;
-        const size_t                          m_rank;
-        std::unique_ptr<Node>                 m_next{};
-        std::unique_ptr<Node>                 m_child{};
-        std::shared_ptr<std::list<ItemType>>  m_values{};
+        Ckey                    m_ckey;
+        const size_t            m_rank;
+        Ptr<Node>               m_next{};
+        Ptr<Node>               m_child{};
+        std::shared_ptr<ValueList> m_values{};
     };
 
+    // Heads form a doubly linked list owned by the heap: every unlinked head is destroyed by the heap itself
     struct Head
     {
-        Head(size_t rank, std::unique_ptr<Node> queue = {})
+        Head(size_t rank, Ptr<Node> queue = {})
             : m_queue{std::move(queue)}
             , m_rank{rank} {}
 
-        std::unique_ptr<Node> ExtractQueue() { return std::move(m_queue); }
+        Ptr<Node> ExtractQueue() { return std::move(m_queue); }
 
-        const std::unique_ptr<Node>& GetQueue() const { return m_queue; }
-        const std::shared_ptr<Head>& GetNext() const { return m_next; }
-        const std::shared_ptr<Head>& GetPrev() const { return m_prev; }
-        const std::shared_ptr<Head>& GetSuffixMin() const { return m_suffix_min; }
-        size_t                       GetRank() const { return m_rank; }
+        const Ptr<Node>& GetQueue() const { return m_queue; }
+        Head*            GetNext() const { return m_next; }
+        Head*            GetPrev() const { return m_prev; }
+        Head*            GetSuffixMin() const { return m_suffix_min; }
+        size_t           GetRank() const { return m_rank; }
 
-        void SetNext(const std::shared_ptr<Head>& next) { m_next = next; }
-        void SetPrev(const std::shared_ptr<Head>& prev) { m_prev = prev; }
-        void SetSuffixMin(const std::shared_ptr<Head>& suffix_min) { m_suffix_min = suffix_min; }
+        void SetNext(Head* next) { m_next = next; }
+        void SetPrev(Head* prev) { m_prev = prev; }
+        void SetSuffixMin(Head* suffix_min) { m_suffix_min = suffix_min; }
     private:
-        std::unique_ptr<Node> m_queue{};
-        std::shared_ptr<Head> m_next{};
-        std::shared_ptr<Head> m_prev{};
-        std::shared_ptr<Head> m_suffix_min{};
-        const size_t          m_rank{};
+        Ptr<Node>    m_queue{};
+        Head*        m_next{};
+        Head*        m_prev{};
+        Head*        m_suffix_min{};
+        const size_t m_rank{};
     };
 
     Node* FindMinNode();
-    void  Meld(std::unique_ptr<Node> q);
-    void  FixMinlist(std::shared_ptr<Head> h);
+    void  Meld(Ptr<Node> q);
+    void  FixMinlist(Head* h);
+    void  Unlink(Head* h);
+    void  Destroy(Head* h) { Ptr<Head>{h, Deleter<Head>{Rebind<Head>{m_allocator}}}.reset(); }
+    void  Clear();
 private:
-    std::shared_ptr<Head>                                           m_header{};
-    std::shared_ptr<Head>                                           m_tail{};
+    Allocator                                                       m_allocator;
+    Head*                                                           m_header{};
+    Head*                                                           m_tail{};
     const size_t                                                    m_r;
-    const std::function<void(ItemType& item, const ItemType& ckey)> m_on_key_raised;
+    size_t                                                          m_pending_raises{};
+    const std::function<bool(ItemType& item, const ItemType& ckey)> m_on_key_raised;
+    SoftHeapObserver*                                               m_observer{};
 };
 
-template<typename ItemType>
-SoftHeapCpp<ItemType>::SoftHeapCpp(size_t r, std::function<void(ItemType& value, const ItemType& ckey)> on_key_raised)
-    : m_header{std::make_shared<Head>(0)}
-    , m_tail{std::make_shared<Head>(std::numeric_limits<size_t>::max())}
+template<typename ItemType, typename Allocator>
+SoftHeapCpp<ItemType, Allocator>::SoftHeapCpp(size_t                                                     r,
+                                              std::function<bool(ItemType& value, const ItemType& ckey)> on_key_raised,
+                                              const Allocator&                                           allocator)
+    : m_allocator{allocator}
+    , m_header{Create<Head>(m_allocator, 0).release()}
+    , m_tail{Create<Head>(m_allocator, std::numeric_limits<size_t>::max()).release()}
     , m_r(r)
     , m_on_key_raised{std::move(on_key_raised)}
 {
@@ -194,31 +403,58 @@ SoftHeapCpp<ItemType>::SoftHeapCpp(size_t r, std::function<void(ItemType& value,
     m_tail->SetPrev(m_header);
 }
 
-template<typename ItemType>
-void SoftHeapCpp<ItemType>::Insert(ItemType new_key)
+template<typename ItemType, typename Allocator>
+SoftHeapCpp<ItemType, Allocator>::SoftHeapCpp(SoftHeapCpp&& other) noexcept
+    : m_allocator{other.m_allocator}
+    , m_header{std::exchange(other.m_header, nullptr)}
+    , m_tail{std::exchange(other.m_tail, nullptr)}
+    , m_r{other.m_r}
+    , m_pending_raises{other.m_pending_raises}
+    , m_on_key_raised{other.m_on_key_raised}
+    , m_observer{other.m_observer} {}
+
+template<typename ItemType, typename Allocator>
+SoftHeapCpp<ItemType, Allocator>::~SoftHeapCpp()
+{
+    if (!m_header)
+        return;
+
+    Clear();
+    Destroy(m_header);
+    Destroy(m_tail);
+}
+
+template<typename ItemType, typename Allocator>
+typename SoftHeapCpp<ItemType, Allocator>::ListRef SoftHeapCpp<ItemType, Allocator>::Insert(ItemType new_key)
 {
-    Meld(std::make_unique<Node>(std::move(new_key)));
+    if (m_observer)
+        m_observer->OnInsert();
+    // Only postponed on_key_raised needs ckeys of single items
+    auto node = Create<Node>(m_allocator, std::move(new_key), m_allocator, static_cast<bool>(m_on_key_raised));
+    auto list = node->GetListRef();
+    Meld(std::move(node));
+    return list;
 }
 
-template<typename ItemType>
-ItemType* SoftHeapCpp<ItemType>::FindMin()
+template<typename ItemType, typename Allocator>
+ItemType* SoftHeapCpp<ItemType, Allocator>::FindMin()
 {
     auto node = FindMinNode();
     if (!node || node->IsNoValues())
         return nullptr;
-    return &node->FrontValue();
+    return &node->FrontValue(m_on_key_raised, m_observer);
 }
 
-template<typename ItemType>
-ItemType SoftHeapCpp<ItemType>::DeleteMin()
+template<typename ItemType, typename Allocator>
+ItemType SoftHeapCpp<ItemType, Allocator>::DeleteMin()
 {
     auto node = FindMinNode();
     assert(node);
-    return node->PopValue();
+    return node->PopValue(m_on_key_raised, m_observer);
 }
 
-template<typename ItemType>
-void SoftHeapCpp<ItemType>::Meld(SoftHeapCpp& other)
+template<typename ItemType, typename Allocator>
+void SoftHeapCpp<ItemType, Allocator>::Meld(SoftHeapCpp& other)
 {
     auto h = other.m_header->GetNext();
 
@@ -227,14 +463,53 @@ void SoftHeapCpp<ItemType>::Meld(SoftHeapCpp& other)
         Meld(h->ExtractQueue());
         h = h->GetNext();
     }
+    m_pending_raises += std::exchange(other.m_pending_raises, 0);
+    other.Clear();
+}
+
+template<typename ItemType, typename Allocator>
+void SoftHeapCpp<ItemType, Allocator>::Flush()
+{
+    if (!m_pending_raises || !m_on_key_raised)
+        return;
+
+    for (auto h = m_header->GetNext(); h != m_tail; h = h->GetNext())
+    {
+        h->GetQueue()->ForEachValues([&](Values& values, const ItemType& ckey)
+        {
+            for (auto& value : values)
+            {
+                if (value < ckey && m_on_key_raised(value, ckey) && m_observer)
+                    m_observer->OnCorrupted();
+            }
+        });
+    }
+    m_pending_raises = 0;
+}
+
+template<typename ItemType, typename Allocator>
+void SoftHeapCpp<ItemType, Allocator>::Flush(ItemType& item, const ListRef& list)
+{
+    if (!list || !m_on_key_raised)
+        return;
+
+    auto last = list;
+    while (last->merged_into)
+        last = last->merged_into;
+    // Compress the chain, so later lookups of items of the same list are short
+    for (auto cell = list; cell != last;)
+        cell = std::exchange(cell->merged_into, last);
+
+    if (last->ckey && item < *last->ckey && m_on_key_raised(item, *last->ckey) && m_observer)
+        m_observer->OnCorrupted();
 }
 
-template<typename ItemType>
-typename SoftHeapCpp<ItemType>::Node* SoftHeapCpp<ItemType>::FindMinNode()
+template<typename ItemType, typename Allocator>
+typename SoftHeapCpp<ItemType, Allocator>::Node* SoftHeapCpp<ItemType, Allocator>::FindMinNode()
 {
     assert(m_header->GetNext());
 
-    std::shared_ptr<Head> h = m_header->GetNext()->GetSuffixMin();
+    Head* h = m_header->GetNext()->GetSuffixMin();
     while (h && h->GetQueue()->IsNoValues())
     {
         size_t                                               child_count = 0;
@@ -243,23 +518,24 @@ typename SoftHeapCpp<ItemType>::Node* SoftHeapCpp<ItemType>::FindMinNode()
         // remeld childs
         if (child_count < h->GetRank() / 2)
         {
-            h->GetPrev()->SetNext(h->GetNext());
-            h->GetNext()->SetPrev(h->GetPrev());
+            Unlink(h);
             FixMinlist(h->GetPrev());
 
             h->GetQueue()->ForEachNodeWithChildOnLevel([&](Node* node)
             {
                 Meld(node->ExtractChild());
             });
+            Destroy(h);
         }
         else
         {
-            h->GetQueue()->Sift(m_r, m_on_key_raised);
+            m_pending_raises += h->GetQueue()->Sift(m_r, m_observer);
             if (h->GetQueue()->IsInfntyCkey())
             {
-                h->GetPrev()->SetNext(h->GetNext());
-                h->GetNext()->SetPrev(h->GetPrev());
-                h = h->GetPrev();
+                Unlink(h);
+                auto removed = h;
+                h            = h->GetPrev();
+                Destroy(removed);
             }
             FixMinlist(h);
         }
@@ -269,8 +545,8 @@ typename SoftHeapCpp<ItemType>::Node* SoftHeapCpp<ItemType>::FindMinNode()
     return h ? h->GetQueue().get() : nullptr;
 }
 
-template<typename ItemType>
-void SoftHeapCpp<ItemType>::Meld(std::unique_ptr<Node> q)
+template<typename ItemType, typename Allocator>
+void SoftHeapCpp<ItemType, Allocator>::Meld(Ptr<Node> q)
 {
     auto tohead = m_header->GetNext();
     while (q->GetRank() > tohead->GetRank())
@@ -280,8 +556,8 @@ void SoftHeapCpp<ItemType>::Meld(std::unique_ptr<Node> q)
 
     while (q->GetRank() == tohead->GetRank())
     {
-        std::unique_ptr<Node> top;
-        std::unique_ptr<Node> bottom;
+        Ptr<Node> top;
+        Ptr<Node> bottom;
         if (tohead->GetQueue()->GetCkey() > q->GetCkey())
         {
             top    = std::move(q);
@@ -292,12 +568,17 @@ void SoftHeapCpp<ItemType>::Meld(std::unique_ptr<Node> q)
             top    = std::move(tohead->ExtractQueue());
             bottom = std::move(q);
         }
-        q      = std::make_unique<Node>(std::move(top), std::move(bottom));
-        tohead = tohead->GetNext();
+        q      = Create<Node>(m_allocator, std::move(top), std::move(bottom));
+
+        // Queue of tohead is merged into q, so the head itself is not needed anymore
+        auto merged = tohead;
+        tohead      = tohead->GetNext();
+        Unlink(merged);
+        Destroy(merged);
     }
 
     auto rank = q->GetRank();
-    auto h = std::make_shared<Head>(rank, std::move(q));
+    auto h = Create<Head>(m_allocator, rank, std::move(q)).release();
     h->SetPrev(prevhead);
     h->SetNext(tohead);
     prevhead->SetNext(h);
@@ -306,10 +587,10 @@ void SoftHeapCpp<ItemType>::Meld(std::unique_ptr<Node> q)
     FixMinlist(h);
 }
 
-template<typename ItemType>
-void SoftHeapCpp<ItemType>::FixMinlist(std::shared_ptr<Head> h)
+template<typename ItemType, typename Allocator>
+void SoftHeapCpp<ItemType, Allocator>::FixMinlist(Head* h)
 {
-    std::shared_ptr<Head> tmpmin;
+    Head* tmpmin;
     if (h->GetNext() == m_tail)
         tmpmin = h;
     else
@@ -323,17 +604,33 @@ void SoftHeapCpp<ItemType>::FixMinlist(std::shared_ptr<Head> h)
     }
 }
 
-template<typename ItemType>
-void SoftHeapCpp<ItemType>::Node::Sift(const size_t r,  const std::function<void(ItemType& item, const ItemType& ckey)>& action)
+template<typename ItemType, typename Allocator>
+void SoftHeapCpp<ItemType, Allocator>::Unlink(Head* h)
+{
+    h->GetPrev()->SetNext(h->GetNext());
+    h->GetNext()->SetPrev(h->GetPrev());
+}
+
+template<typename ItemType, typename Allocator>
+void SoftHeapCpp<ItemType, Allocator>::Clear()
+{
+    for (auto h = m_header->GetNext(); h != m_tail;)
+        Destroy(std::exchange(h, h->GetNext()));
+    m_header->SetNext(m_tail);
+    m_tail->SetPrev(m_header);
+}
+
+template<typename ItemType, typename Allocator>
+size_t SoftHeapCpp<ItemType, Allocator>::Node::Sift(const size_t r, SoftHeapObserver* observer)
 {
     m_values.reset();
     if (!m_next && !m_child)
     {
         m_ckey.reset();
-        return;
+        return 0;
     }
 
-    m_next->Sift(r, action);
+    size_t concatenations = m_next->Sift(r, observer);
 
     if (m_next->GetCkey() > m_child->GetCkey())
         std::swap(m_child, m_next);
@@ -345,31 +642,34 @@ void SoftHeapCpp<ItemType>::Node::Sift(const size_t r,  const std::function<void
     if (GetRank() > r &&
         (GetRank() % 2 == 1 || m_child->GetRank() < GetRank() - 1))
     {
-        m_next->Sift(r, action);
+        concatenations += m_next->Sift(r, observer);
 
         if (m_next->GetCkey() > m_child->GetCkey())
             std::swap(m_child, m_next);
 
         // Concatenate lists if not empty
-        if (!m_next->IsInfntyCkey() && !m_next->m_values->empty())
+        if (!m_next->IsInfntyCkey() && !m_next->m_values->values.empty())
         {
-            m_values->insert(m_values->begin(),
-                             std::make_move_iterator(m_next->m_values->begin()),
-                             std::make_move_iterator(m_next->m_values->end()));
-            m_next->m_values->clear();
-            m_next->m_values.reset();
+            auto& to   = m_values->values;
+            auto& from = m_next->m_values->values;
+            // Lists of heaps with different allocators can't be spliced, it is possible only after meld
+            if (to.get_allocator() == from.get_allocator())
+                to.splice(to.begin(), from);
+            else
+                to.insert(to.begin(), std::make_move_iterator(from.begin()), std::make_move_iterator(from.end()));
+            from.clear();
             m_ckey = m_next->m_ckey;
-            for(auto& value : *m_values)
-            {
-                if (value < *m_ckey)
-                    action(value, *m_ckey);
-            }
+            LinkCkeys(m_values, m_next->m_values, m_ckey);
+            m_next->m_values.reset();
+            ++concatenations;
+            if (observer)
+                observer->OnCkeyRaised(GetRank(), to.size());
         }
     } /*  end of second sift */
 
     // Clean Up
     if (!m_child->IsInfntyCkey())
-        return;
+        return concatenations;
 
     if (m_next->IsInfntyCkey())
     {
@@ -378,7 +678,10 @@ void SoftHeapCpp<ItemType>::Node::Sift(const size_t r,  const std::function<void
     }
     else
     {
-        m_child = std::move(m_next->m_child);
-        m_next  = std::move(m_next->m_next);
+        // Keep old next alive until its children are moved out
+        auto next = std::move(m_next);
+        m_child   = std::move(next->m_child);
+        m_next    = std::move(next->m_next);
     }
+    return concatenations;
 }
@@ -1,6 +1,7 @@
 #include "Common.h"
 #include "SoftHeapC.h"
 
+#include <memory_resource>
 #include <numeric>
 #include <random>
 #include <SoftHeapCpp.h>
@@ -113,6 +114,56 @@ TEST(SoftHeapCpp, WithSomeR)
     }
 }
 
+TEST(SoftHeapCpp, PackedKeysBreakTiesByIndex)
+{
+    // Weight in high half, index in low half: equal weights are popped in order of indexes
+    constexpr uint64_t    count = 1000;
+    SoftHeapCpp<uint64_t> heap(10000);
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        const uint64_t index = (i * 7919) % count;
+        heap.Insert((index % 10) << 32 | index);
+    }
+
+    std::vector<uint64_t> popped{};
+    for (uint64_t i = 0; i < count; ++i)
+        popped.push_back(heap.DeleteMin());
+
+    EXPECT_TRUE(std::ranges::is_sorted(popped));
+    EXPECT_EQ(std::ranges::adjacent_find(popped), popped.end());
+}
+
+TEST(SoftHeapCpp, ObserverCountsCorruption)
+{
+    for (size_t r : {0, 10000})
+    {
+        SoftHeapCounters counters{};
+        SoftHeapCpp<int> heap(r);
+        heap.SetObserver(&counters);
+
+        constexpr int count = 1000;
+        for (int i = 0; i < count; ++i)
+            heap.Insert((i * 7919) % count);
+        for (int i = 0; i < count; ++i)
+            heap.DeleteMin();
+
+        EXPECT_EQ(counters.inserts, count);
+        EXPECT_EQ(std::accumulate(counters.raises_per_rank.begin(), counters.raises_per_rank.end(), size_t{0}), counters.ckey_raises);
+        if (r == 0)
+        {
+            EXPECT_GT(counters.ckey_raises, 0);
+            EXPECT_GT(counters.corrupted, 0);
+            EXPECT_GE(counters.max_list_size, 2);
+        }
+        else
+        {
+            // Ranks never exceed r, so sift does not concatenate lists
+            EXPECT_EQ(counters.ckey_raises, 0);
+            EXPECT_EQ(counters.corrupted, 0);
+        }
+    }
+}
+
 TEST(SoftHeapCpp, AsKthLargestElement)
 {
     for (auto count : { 3, 5, 10, 30, 40, 51, 73, 91, 132 })
@@ -232,3 +283,166 @@ TEST(SoftHeapCpp, FindMin)
     EXPECT_EQ(heap.DeleteMin(), 2);
 
 }
+
+// Upstream resource which tracks amount of not released memory
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    size_t GetAllocatedBytes() const { return m_allocated; }
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        m_allocated += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override
+    {
+        m_allocated -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+
+    size_t m_allocated = 0;
+};
+
+using PmrSoftHeap = SoftHeapCpp<int, std::pmr::polymorphic_allocator<int>>;
+
+TEST(SoftHeapCpp, ReleasesMemoryAfterMeld)
+{
+    CountingResource resource{};
+    {
+        PmrSoftHeap heap{Utils::CalculateRByEps(1.0 / 3.0), {}, &resource};
+        PmrSoftHeap other{Utils::CalculateRByEps(1.0 / 3.0), {}, &resource};
+        for (int i = 0; i < 1000; ++i)
+        {
+            heap.Insert(i);
+            other.Insert(1000 + i);
+        }
+
+        heap.Meld(other);
+        EXPECT_EQ(other.FindMin(), nullptr);
+
+        for (int i = 0; i < 500; ++i)
+            heap.DeleteMin();
+
+        EXPECT_GT(resource.GetAllocatedBytes(), 0);
+    }
+    EXPECT_EQ(resource.GetAllocatedBytes(), 0);
+}
+
+TEST(SoftHeapCpp, PoolRecyclesNodes)
+{
+    CountingResource                       upstream{};
+    std::pmr::unsynchronized_pool_resource pool{&upstream};
+
+    size_t allocated_after_first_heap = 0;
+    for (int iteration = 0; iteration < 50; ++iteration)
+    {
+        {
+            PmrSoftHeap heap{Utils::CalculateRByEps(1.0 / 3.0), {}, &pool};
+            for (int i = 0; i < 1000; ++i)
+                heap.Insert((i * 7919) % 1000);
+            for (int i = 0; i < 1000; ++i)
+                heap.DeleteMin();
+        }
+        if (iteration == 0)
+            allocated_after_first_heap = upstream.GetAllocatedBytes();
+    }
+    EXPECT_EQ(upstream.GetAllocatedBytes(), allocated_after_first_heap);
+}
+
+TEST(SoftHeapCpp, TrackedInsertsAllocateNoCells)
+{
+    // Ranks of 1000 items stay below r, so sift never concatenates lists and reused lists get no new cells
+    constexpr size_t r = 64;
+    CountingResource untracked_resource{};
+    CountingResource tracked_resource{};
+    PmrSoftHeap      untracked{r, {}, &untracked_resource};
+    PmrSoftHeap      tracked{r, [](int&, const int&) { return true; }, &tracked_resource};
+
+    std::vector<PmrSoftHeap::ListRef> lists{};
+    for (int i = 0; i < 1000; ++i)
+    {
+        untracked.Insert((i * 7919) % 1000);
+        lists.push_back(tracked.Insert((i * 7919) % 1000));
+        EXPECT_TRUE(lists.back());
+    }
+    EXPECT_EQ(tracked_resource.GetAllocatedBytes(), untracked_resource.GetAllocatedBytes());
+}
+
+TEST(SoftHeapCpp, FlushRaisesKeys)
+{
+    struct Item
+    {
+        bool operator<(const Item& rhs) const { return *cost < *rhs.cost; }
+
+        std::shared_ptr<int> cost;
+    };
+
+    constexpr int                     count = 1000;
+    std::vector<std::shared_ptr<int>> costs{};
+    SoftHeapCpp<Item>                 heap(0, [](Item& item, const Item& ckey) { *item.cost = *ckey.cost; return true; });
+    for (int i = 0; i < count; ++i)
+    {
+        costs.push_back(std::make_shared<int>((i * 7919) % count));
+        heap.Insert(Item{costs.back()});
+    }
+
+    int last_popped = -1;
+    for (int i = 0; i < count / 2; ++i)
+    {
+        const auto item = heap.DeleteMin();
+        EXPECT_GE(*item.cost, last_popped);
+        last_popped = *item.cost;
+        costs.erase(std::ranges::find(costs, item.cost));
+    }
+
+    heap.Flush();
+    EXPECT_TRUE(std::ranges::all_of(costs, [&](const auto& cost) { return *cost >= last_popped; }));
+}
+
+TEST(SoftHeapCpp, FlushOfItemRaisesItsKeyOnly)
+{
+    struct Item
+    {
+        bool operator<(const Item& rhs) const { return *cost < *rhs.cost; }
+
+        std::shared_ptr<int> cost;
+    };
+
+    constexpr int count = 1000;
+    const auto    raise = [](Item& item, const Item& ckey) { *item.cost = *ckey.cost; return true; };
+
+    std::vector<std::shared_ptr<int>>            all_costs{};
+    std::vector<std::shared_ptr<int>>            item_costs{};
+    std::vector<SoftHeapCpp<Item>::ListRef>      lists{};
+    SoftHeapCpp<Item>                            all_heap(0, raise);
+    SoftHeapCpp<Item>                            item_heap(0, raise);
+    for (int i = 0; i < count; ++i)
+    {
+        all_costs.push_back(std::make_shared<int>((i * 7919) % count));
+        item_costs.push_back(std::make_shared<int>((i * 7919) % count));
+        all_heap.Insert(Item{all_costs.back()});
+        lists.push_back(item_heap.Insert(Item{item_costs.back()}));
+    }
+
+    std::vector<bool> popped(count);
+    for (int i = 0; i < count / 2; ++i)
+    {
+        all_heap.DeleteMin();
+        const auto item = item_heap.DeleteMin();
+        popped[std::ranges::find(item_costs, item.cost) - item_costs.begin()] = true;
+    }
+
+    all_heap.Flush();
+    for (int i = 0; i < count; ++i)
+    {
+        if (popped[i])
+            continue;
+        Item copy{item_costs[i]};
+        item_heap.Flush(copy, lists[i]);
+        EXPECT_EQ(*item_costs[i], *all_costs[i]);
+    }
+}